@@ -0,0 +1,48 @@
+#ifndef BENCHMARK_CITY_WALKS_HH
+#define BENCHMARK_CITY_WALKS_HH
+
+#include <random>
+
+#include "GridModel.hh"
+
+// Class definition -------------------------------------------------------------------------------
+// Vehicles driving along the streets of a square city with a location every 50 m
+inline void generateCityWalks(GridData &gridData, GridStats &gridStats, mt19937_64 &random, int count) {
+    const int32_t blocks = 120;
+    const int32_t blockSize = 200000;
+    const int32_t stepSize = 50000;
+    const int32_t margin = 1000;
+    uniform_int_distribution<int32_t> intersection(0, blocks - 1);
+    uniform_int_distribution<int32_t> jitter(-150, 150);
+    uniform_int_distribution<int> turns(5, 40);
+
+    for (int i = 0; i < count; i++) {
+        esw::Walk walk;
+        int32_t bx = intersection(random);
+        int32_t by = intersection(random);
+        auto *location = walk.add_locations();
+        location->set_x(margin + bx * blockSize + jitter(random));
+        location->set_y(margin + by * blockSize + jitter(random));
+
+        for (int t = turns(random); t > 0; t--) {
+            int direction = random() % 4;
+            int32_t dx = direction == 0 ? 1 : direction == 1 ? -1 : 0;
+            int32_t dy = direction == 2 ? 1 : direction == 3 ? -1 : 0;
+            if (bx + dx < 0 || bx + dx >= blocks || by + dy < 0 || by + dy >= blocks) continue;
+            // Every third street is one-way
+            if ((dx < 0 && by % 3 == 1) || (dy < 0 && bx % 3 == 1)) continue;
+
+            for (int32_t offset = stepSize; offset <= blockSize; offset += stepSize) {
+                location = walk.add_locations();
+                location->set_x(margin + bx * blockSize + dx * offset + jitter(random));
+                location->set_y(margin + by * blockSize + dy * offset + jitter(random));
+                walk.add_lengths(stepSize + 500 + random() % 2000);
+            }
+            bx += dx;
+            by += dy;
+        }
+        processWalk(gridData, gridStats, walk);
+    }
+}
+
+#endif //BENCHMARK_CITY_WALKS_HH
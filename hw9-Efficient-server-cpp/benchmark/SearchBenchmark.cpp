@@ -0,0 +1,303 @@
+
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <arpa/inet.h>
+
+#include "GridModel.hh"
+#include "ThreadPool.hh"
+#include "CityWalks.hh"
+
+// Global variables -------------------------------------------------------------------------------
+#define BENCHMARK_ONE_TO_ALL    20
+#define BENCHMARK_ONE_TO_ONE    200
+#define BENCHMARK_SYNTH_WALKS   20000
+#define BENCHMARK_MIN_HELPERS   3
+#define BENCHMARK_ROUNDS        20
+#define BENCHMARK_ROUND_WALKS   5
+<<<<<<< HEAD
+#define BENCHMARK_RESOLVE_LOCATIONS 1500000
+#define BENCHMARK_RESOLVE_WALK      200
+#define BENCHMARK_RESOLVE_JITTER    400
+=======
+#define BENCHMARK_DRIFT_WALKS   20
+>>>>>>> e4b7306 ([user-021] Add an ALT landmark index for OneToOne search)
+
+PrefixedLogger benchLogger = PrefixedLogger("[BENCHMARK ]", true);
+
+GridData gridData = GridData();
+GridStats gridStats = GridStats();
+
+// Checks failed along the measurements, the benchmark exits with an error after any
+static uint32_t failures = 0;
+
+// Helpers are forced even on few cores so that the parallel search is always cross-checked
+ThreadPool resourcePool1(max<uint32_t>(BENCHMARK_MIN_HELPERS, thread::hardware_concurrency() - 1));
+
+// Class definition -------------------------------------------------------------------------------
+// Replays the Walk and Reset messages of a length-prefixed request stream
+static bool loadRequests(const string &path) {
+    ifstream input(path, ios::binary);
+    if (!input) return false;
+
+    vector<char> buffer;
+    uint32_t size;
+    while (input.read(reinterpret_cast<char *>(&size), sizeof(size))) {
+        size = ntohl(size);
+        buffer.resize(size);
+        if (!input.read(buffer.data(), size)) break;
+
+        esw::Request request;
+        if (!request.ParseFromArray(buffer.data(), size)) break;
+        if (request.has_walk()) processWalk(gridData, gridStats, request.walk());
+        if (request.has_reset()) processReset(gridData, gridStats);
+    }
+    return true;
+}
+
+// City walks ingested into the grid of the benchmark
+static void generateWalks(mt19937_64 &random, int count) {
+    generateCityWalks(gridData, gridStats, random, count);
+}
+
+// Resolves walks of locations around the cells of the grid one location at a time and in batches of a walk,
+// both have to resolve every location to the same cell
+static void benchmarkResolution(mt19937_64 &random) {
+    if (gridData.cellIds.empty()) return;
+    uniform_int_distribution<int32_t> jitter(-BENCHMARK_RESOLVE_JITTER, BENCHMARK_RESOLVE_JITTER);
+    vector<Point> points;
+    points.reserve(BENCHMARK_RESOLVE_LOCATIONS);
+    for (int i = 0; i < BENCHMARK_RESOLVE_LOCATIONS; i++) {
+        uint64_t cellId = gridData.cellIds[random() % gridData.cellIds.size()];
+        Point cell = gridData.cells[cellId % CHUNKS].find(cellId)->second.point();
+        points.push_back({static_cast<uint64_t>(static_cast<int32_t>(cell.x) + jitter(random)),
+                          static_cast<uint64_t>(static_cast<int32_t>(cell.y) + jitter(random))});
+    }
+
+    // The first pass adds the cells of locations without a neighbour, the measured passes find all cells
+    vector<uint64_t> single(points.size());
+    auto resolveEach = [&]() {
+        for (size_t i = 0; i < points.size(); i++) {
+            single[i] = gridData.getPointCellId(points[i]);
+            gridData.addPoint(gridStats, points[i], single[i]);
+        }
+    };
+    resolveEach();
+    auto start = chrono::high_resolution_clock::now();
+    resolveEach();
+    auto stop = chrono::high_resolution_clock::now();
+    uint64_t micros = chrono::duration_cast<chrono::microseconds>(stop - start).count();
+    benchLogger.info("%-42s %10lu us %10.1f ns/location", ("resolution of " + to_string(points.size()) +
+                     " locations").c_str(), micros, 1000.0 * micros / points.size());
+
+    vector<uint64_t> batched;
+    vector<Point> walk;
+    vector<uint64_t> walkCellIds;
+    batched.reserve(points.size());
+    start = chrono::high_resolution_clock::now();
+    for (size_t first = 0; first < points.size(); first += BENCHMARK_RESOLVE_WALK) {
+        walk.assign(points.begin() + first, points.begin() + min<size_t>(first + BENCHMARK_RESOLVE_WALK,
+                                                                          points.size()));
+        gridData.addWalkPoints(gridStats, walk, walkCellIds);
+        batched.insert(batched.end(), walkCellIds.begin(), walkCellIds.end());
+    }
+    stop = chrono::high_resolution_clock::now();
+    micros = chrono::duration_cast<chrono::microseconds>(stop - start).count();
+    benchLogger.info("%-42s %10lu us %10.1f ns/location", ("batched resolution of walks of " +
+                     to_string(BENCHMARK_RESOLVE_WALK)).c_str(), micros, 1000.0 * micros / points.size());
+    if (batched != single) {
+        benchLogger.error("batched resolution results differ");
+        failures++;
+    }
+}
+
+template<typename Search>
+static uint64_t measure(const string &name, vector<uint64_t> &results, Search search, size_t count) {
+    auto start = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        results[i] = search(i);
+    }
+    auto stop = chrono::high_resolution_clock::now();
+    uint64_t micros = chrono::duration_cast<chrono::microseconds>(stop - start).count();
+    benchLogger.info("%-42s %10lu us %10.1f us/query", name.c_str(), micros, double(micros) / count);
+    return micros;
+}
+
+template<typename Queue>
+static void benchmarkQueue(const string &queueName, const GridGraph &graph, const ChainGraph &chainGraph,
+                           const LandmarkBounds &bounds, const vector<uint32_t> &allOrigins, const vector<pair<uint32_t, uint32_t>> &pairs,
+                           vector<vector<uint64_t>> &expected) {
+    vector<vector<uint64_t>> results(6);
+    results[0].resize(allOrigins.size());
+    for (size_t i = 1; i < 4; i++) results[i].resize(pairs.size());
+    results[4].resize(allOrigins.size());
+    results[5].resize(pairs.size());
+
+    measure(queueName + " OneToAll", results[0], [&](size_t i) {
+        return dijkstra<Queue>(graph, allOrigins[i], NO_CELL, ONE_TO_ALL);
+    }, allOrigins.size());
+    measure(queueName + " OneToOne", results[1], [&](size_t i) {
+        return dijkstra<Queue>(graph, pairs[i].first, pairs[i].second, ONE_TO_ONE);
+    }, pairs.size());
+    measure(queueName + " OneToOne bidirectional", results[2], [&](size_t i) {
+        return bidirectionalDijkstra<Queue>(graph, pairs[i].first, pairs[i].second);
+    }, pairs.size());
+    measure(queueName + " OneToOne A*", results[3], [&](size_t i) {
+        return aStar<Queue>(graph, pairs[i].first, pairs[i].second);
+    }, pairs.size());
+    measure(queueName + " OneToAll chains", results[4], [&](size_t i) {
+        return chainDijkstra<Queue>(graph, chainGraph, allOrigins[i]);
+    }, allOrigins.size());
+    measure(queueName + " OneToOne ALT", results[5], [&](size_t i) {
+        return landmarkAStar<Queue>(graph, bounds, pairs[i].first, pairs[i].second);
+    }, pairs.size());
+
+    // Every queue and search must agree with the first measured one
+    if (expected.empty()) {
+        expected = results;
+        expected[2] = expected[3] = expected[5] = expected[1];
+        expected[4] = expected[0];
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i] != expected[i]) {
+            benchLogger.error("%s results differ in measurement %lu", queueName.c_str(), i);
+            failures++;
+        }
+    }
+}
+
+// Main function -----------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    mt19937_64 random(42);
+
+    auto start = chrono::high_resolution_clock::now();
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            if (!loadRequests(argv[i])) {
+                benchLogger.error("Cannot read %s", argv[i]);
+                failures++;
+            }
+        }
+    } else {
+        benchLogger.info("No request streams given, generating %d walks", BENCHMARK_SYNTH_WALKS);
+        generateWalks(random, BENCHMARK_SYNTH_WALKS);
+    }
+    auto stop = chrono::high_resolution_clock::now();
+    benchLogger.info("Ingested %lu walks with %lu locations in %lu us", gridStats.walk_count.load(),
+                     gridStats.location_count.load(),
+                     chrono::duration_cast<chrono::microseconds>(stop - start).count());
+
+    shared_ptr<const GridSnapshot> snapshot = gridData.publishSnapshot();
+    const GridGraph &graph = snapshot->graph;
+    const ChainGraph &chainGraph = snapshot->getChainGraph();
+    GridMemory memory = gridData.memoryUsage();
+    benchLogger.info("Memory of %lu cells and %lu edges: %lu bytes, cells %lu, spilled edges %lu in %lu cells, "
+                     "edge index %lu, graph %lu, chain graph %lu", memory.cellCount, memory.edgeCount, memory.total(),
+                     memory.cells, memory.spilledEdges, memory.spilledCells, memory.edgeIndex, memory.graph,
+                     memory.chainGraph);
+    benchLogger.info("Graph with %u cells and %lu edges, heuristic scale %f", graph.size(), graph.arcCount(),
+                     graph.heuristicScale);
+    benchLogger.info("Chain graph with %lu junctions and %lu arcs", graph.size() - chainGraph.members.size(),
+                     chainGraph.arcs.size());
+    if (graph.size() == 0) return 1;
+
+    vector<uint32_t> allOrigins;
+    for (int i = 0; i < BENCHMARK_ONE_TO_ALL; i++) allOrigins.push_back(random() % graph.size());
+    vector<pair<uint32_t, uint32_t>> pairs;
+    for (int i = 0; i < BENCHMARK_ONE_TO_ONE; i++) pairs.push_back({random() % graph.size(), random() % graph.size()});
+
+    auto landmarks = make_shared<LandmarkIndex>();
+    start = chrono::high_resolution_clock::now();
+    landmarks->build(graph);
+    stop = chrono::high_resolution_clock::now();
+    benchLogger.info("%-42s %10lu us", ("landmark index of " + to_string(landmarks->count) + " landmarks").c_str(),
+                     chrono::duration_cast<chrono::microseconds>(stop - start).count());
+    shared_ptr<const LandmarkBounds> bounds = gridData.getLandmarkBounds(landmarks, *snapshot);
+
+    vector<vector<uint64_t>> expected;
+    benchmarkQueue<BinaryHeapQueue>("binary heap", graph, chainGraph, *bounds, allOrigins, pairs, expected);
+    benchmarkQueue<RadixHeapQueue>("radix heap", graph, chainGraph, *bounds, allOrigins, pairs, expected);
+    benchmarkQueue<IndexedDaryHeapQueue<4>>("indexed 4-ary heap", graph, chainGraph, *bounds, allOrigins, pairs,
+                                            expected);
+
+    uint32_t helpers = resourcePool1.size();
+    vector<uint64_t> parallel(allOrigins.size());
+    measure("delta-stepping OneToAll with " + to_string(helpers) + " helpers", parallel, [&](size_t i) {
+        return deltaStepping(graph, chainGraph, allOrigins[i], resourcePool1, helpers);
+    }, allOrigins.size());
+    if (parallel != expected[0]) {
+        benchLogger.error("delta-stepping results differ");
+        failures++;
+    }
+
+    // Repeated OneToAll from one origin between small bursts of walks
+    uint64_t originCellId = gridData.cellIds[allOrigins[0]];
+    function<uint64_t()> unused = []() { return uint64_t(0); };
+    gridData.pathTrees.totalLength(*snapshot, originCellId, allOrigins[0], unused);
+    gridData.pathTrees.totalLength(*snapshot, originCellId, allOrigins[0], unused);
+    uint64_t incrementalMicros = 0;
+    uint64_t fullMicros = 0;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        generateWalks(random, BENCHMARK_ROUND_WALKS);
+        shared_ptr<const GridSnapshot> current = gridData.publishSnapshot();
+        const ChainGraph &currentChains = current->getChainGraph();
+
+        auto start = chrono::high_resolution_clock::now();
+        uint64_t incremental = gridData.pathTrees.totalLength(*current, originCellId, allOrigins[0], unused);
+        auto middle = chrono::high_resolution_clock::now();
+        uint64_t full = chainDijkstra(current->graph, currentChains, allOrigins[0]);
+        auto stop = chrono::high_resolution_clock::now();
+
+        incrementalMicros += chrono::duration_cast<chrono::microseconds>(middle - start).count();
+        fullMicros += chrono::duration_cast<chrono::microseconds>(stop - middle).count();
+        if (incremental != full) {
+            benchLogger.error("incremental OneToAll differs in round %d: %lu instead of %lu", round, incremental, full);
+            failures++;
+        }
+    }
+    benchLogger.info("%-42s %10lu us %10.1f us/query", "incremental OneToAll after walks", incrementalMicros,
+                     double(incrementalMicros) / BENCHMARK_ROUNDS);
+    benchLogger.info("%-42s %10lu us %10.1f us/query", "chain OneToAll after walks", fullMicros,
+                     double(fullMicros) / BENCHMARK_ROUNDS);
+
+<<<<<<< HEAD
+    benchmarkResolution(random);
+
+    if (failures > 0) {
+        benchLogger.error("%u checks failed", failures);
+        return 1;
+=======
+    // An index of the current snapshot is repaired walk by walk, searches with it must stay exact
+    landmarks = make_shared<LandmarkIndex>();
+    landmarks->build(gridData.getSnapshot()->graph);
+    shared_ptr<const GridSnapshot> current;
+    shared_ptr<const LandmarkBounds> repaired;
+    uint64_t repairMicros = 0;
+    for (int walk = 0; walk < BENCHMARK_DRIFT_WALKS; walk++) {
+        generateWalks(random, 1);
+        current = gridData.getSnapshot();
+        if (!landmarks->covers(*current)) {
+            benchLogger.error("edge change log does not reach back to the landmark index");
+            return 1;
+        }
+        auto start = chrono::high_resolution_clock::now();
+        repaired = gridData.getLandmarkBounds(landmarks, *current);
+        auto stop = chrono::high_resolution_clock::now();
+        repairMicros += chrono::duration_cast<chrono::microseconds>(stop - start).count();
+    }
+    benchLogger.info("%-42s %10lu us %10.1f us/walk", ("landmark repair to " + to_string(repaired->repairs()) +
+                     " distances").c_str(), repairMicros, double(repairMicros) / BENCHMARK_DRIFT_WALKS);
+    vector<uint64_t> exact(pairs.size());
+    vector<uint64_t> drifted(pairs.size());
+    measure("OneToOne bidirectional after walks", exact, [&](size_t i) {
+        return bidirectionalDijkstra(current->graph, pairs[i].first, pairs[i].second);
+    }, pairs.size());
+    measure("OneToOne repaired ALT after walks", drifted, [&](size_t i) {
+        return landmarkAStar(current->graph, *repaired, pairs[i].first, pairs[i].second);
+    }, pairs.size());
+    if (drifted != exact) {
+        benchLogger.error("repaired ALT results differ");
+>>>>>>> e4b7306 ([user-021] Add an ALT landmark index for OneToOne search)
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <fstream>
+#include <chrono>
+#include <arpa/inet.h>
+
+#include "GridModel.hh"
+#include "GridStore.hh"
+#include "ThreadPool.hh"
+#include "ThreadTeam.hh"
+
+// Global variables -------------------------------------------------------------------------------
+PrefixedLogger bulkLogger = PrefixedLogger("[BULK LOAD ]", true);
+
+GridData gridData = GridData();
+GridStats gridStats = GridStats();
+
+ThreadPool resourcePool1(max<uint32_t>(1, thread::hardware_concurrency()));
+
+// Class definition -------------------------------------------------------------------------------
+// Walks of a request stream after its last Reset, the requests before it never reach the grid
+struct StreamWalks {
+    vector<esw::Walk> walks;
+    bool reset = false;
+    bool readable = false;
+};
+
+// Parses the Walk and Reset messages of a length-prefixed request stream
+static void decodeStream(const string &path, StreamWalks &stream) {
+    ifstream input(path, ios::binary);
+    if (!input) return;
+    stream.readable = true;
+
+    vector<char> buffer;
+    uint32_t size;
+    while (input.read(reinterpret_cast<char *>(&size), sizeof(size))) {
+        size = ntohl(size);
+        buffer.resize(size);
+        if (!input.read(buffer.data(), size)) break;
+
+        esw::Request request;
+        if (!request.ParseFromArray(buffer.data(), size)) break;
+        if (request.has_walk()) stream.walks.push_back(std::move(*request.mutable_walk()));
+        if (request.has_reset()) {
+            stream.walks.clear();
+            stream.reset = true;
+        }
+    }
+}
+
+// Main function -----------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        cout << "[ERROR] Arguments required <snapshot> <request stream>..." << endl;
+        return 1;
+    }
+    vector<string> paths(argv + 2, argv + argc);
+    vector<StreamWalks> streams(paths.size());
+
+    // Streams are read and parsed on all cores, only applying their walks keeps the order of the streams
+    auto start = chrono::high_resolution_clock::now();
+    {
+        ThreadTeam team(resourcePool1, resourcePool1.size());
+        team.parallelFor(streams.size(), 1, [&](uint32_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) decodeStream(paths[i], streams[i]);
+        });
+    }
+    auto parsed = chrono::high_resolution_clock::now();
+
+    size_t first = 0;
+    for (size_t i = 0; i < streams.size(); i++) {
+        if (!streams[i].readable) {
+            bulkLogger.error("Cannot read %s", paths[i].c_str());
+            return 1;
+        }
+        if (streams[i].reset) first = i;
+    }
+    for (size_t i = first; i < streams.size(); i++) {
+        for (const auto &walk: streams[i].walks) processWalk(gridData, gridStats, walk);
+    }
+    auto applied = chrono::high_resolution_clock::now();
+
+    // The snapshot starts a new deployment, no write-ahead log follows it yet
+    vector<char> image = captureSnapshot(gridData, 0);
+    if (!writeSnapshot(image, argv[1])) {
+        bulkLogger.error("Cannot write the snapshot to %s", argv[1]);
+        return 1;
+    }
+    auto stop = chrono::high_resolution_clock::now();
+    bulkLogger.info("Snapshot of %lu cells and %lu edges from %lu walks written to %s", gridData.cellIds.size(),
+                    gridStats.edges_count.load(), gridStats.walk_count.load(), argv[1]);
+    bulkLogger.info("Parsed in %lu ms, applied in %lu ms, written in %lu ms",
+                    chrono::duration_cast<chrono::milliseconds>(parsed - start).count(),
+                    chrono::duration_cast<chrono::milliseconds>(applied - parsed).count(),
+                    chrono::duration_cast<chrono::milliseconds>(stop - applied).count());
+    return 0;
+}
@@ -12,6 +12,65 @@ option(ENABLE_ERROR_LOG "Enable error logging level" ON)
 # Option for enabling locking
 option(ENABLE_LOCKING "Enable grid locking" OFF)
 
+# Option for the OneToOne search algorithm, A* takes precedence over the bidirectional search
+option(ENABLE_BIDIRECTIONAL_SEARCH "Enable bidirectional OneToOne search" ON)
+option(ENABLE_ASTAR_SEARCH "Enable goal-directed A* OneToOne search" OFF)
+
+# Option for the ALT OneToOne search bounded by the distances to far-apart landmark cells, takes precedence over
+# the above once the index is built. The index is rebuilt in the background after the given edge changes
+option(ENABLE_LANDMARK_SEARCH "Enable landmark A* OneToOne search" OFF)
+add_definitions(-DLANDMARK_COUNT=8)
+add_definitions(-DLANDMARK_REBUILD_CHANGES=2048)
+
+# Option for searching OneToAll on the graph with chains of cells collapsed into shortcuts
+option(ENABLE_CHAIN_COMPRESSION "Enable chain compressed OneToAll search" ON)
+
+# Option for the parallel delta-stepping OneToAll search on the chain graph, takes precedence over the above
+option(ENABLE_PARALLEL_SEARCH "Enable parallel delta-stepping OneToAll search" ON)
+# Bucket width of the delta-stepping search in millimetres, 0 picks the mean arc length
+add_definitions(-DDELTA_STEPPING_WIDTH=0)
+
+# Option for caching query results until the grid changes, capacity in results
+option(ENABLE_QUERY_CACHE "Enable versioned query result cache" ON)
+add_definitions(-DQUERY_CACHE_CAPACITY=65536)
+
+# Option for updating the OneToAll trees of repeated origins over the edge changes since the last query
+option(ENABLE_INCREMENTAL_SEARCH "Enable incremental OneToAll search" ON)
+add_definitions(-DINCREMENTAL_TREES=4)
+add_definitions(-DINCREMENTAL_MAX_CHANGES=4096)
+
+# Option for resolving all locations of a walk at once with the neighbour tests in SIMD lanes
+option(ENABLE_BATCH_RESOLUTION "Enable batched SIMD cell resolution of walks" OFF)
+
+# Option for applying walks of disjoint cell chunks concurrently on more ingestion threads, takes precedence
+# over the batched resolution and excludes the tiled index
+option(ENABLE_CONCURRENT_INGESTION "Enable concurrent walk ingestion" OFF)
+add_definitions(-DINGESTION_THREADS=4)
+
+# Option for queueing walks and resets to a single writer applying them in batches under one lock acquisition,
+# excludes the concurrent ingestion
+option(ENABLE_BATCHED_INGESTION "Enable batched single-writer ingestion" OFF)
+add_definitions(-DINGEST_MAX_BATCH=256)
+
+# Option for reading further requests of a connection while its earlier ones are processed, requests wait
+# only for the earlier requests of their own connection and answer in the order of the connection
+option(ENABLE_CONNECTION_ORDERING "Enable pipelined connections ordered per connection" OFF)
+
+# Pause between the background snapshots of a changed grid, taken when the server is given a snapshot file
+add_definitions(-DSNAPSHOT_INTERVAL_MS=10000)
+
+# Option for logging the walks and resets beside the snapshot file and acknowledging them once durable, needs
+# the batched ingestion. A sync interval above 0 delays the fdatasync of a batch to group it with later ones
+option(ENABLE_WRITE_AHEAD_LOG "Enable write-ahead log of walks and resets" OFF)
+add_definitions(-DWAL_SYNC_INTERVAL_US=0)
+
+# Option for resolving cells through the tiled index instead of the chunk maps, pays off on dense grids only
+option(ENABLE_CELL_TILE_INDEX "Enable tiled cell index" OFF)
+
+# Option for the search priority queue, the radix heap takes precedence over the 4-ary heap
+option(ENABLE_RADIX_QUEUE "Enable radix heap search queue" ON)
+option(ENABLE_DARY_QUEUE "Enable indexed 4-ary heap search queue" OFF)
+
 # Conditionally add definitions based on the configuration option
 if (ENABLE_LOGGER_THREAD)
     add_definitions(-DENABLE_LOGGER_THREAD)
@@ -34,3 +93,48 @@ endif ()
 if (ENABLE_LOCKING)
     add_definitions(-DENABLE_LOCKING)
 endif ()
+if (ENABLE_BIDIRECTIONAL_SEARCH)
+    add_definitions(-DENABLE_BIDIRECTIONAL_SEARCH)
+endif ()
+if (ENABLE_ASTAR_SEARCH)
+    add_definitions(-DENABLE_ASTAR_SEARCH)
+endif ()
+if (ENABLE_LANDMARK_SEARCH)
+    add_definitions(-DENABLE_LANDMARK_SEARCH)
+endif ()
+if (ENABLE_CHAIN_COMPRESSION)
+    add_definitions(-DENABLE_CHAIN_COMPRESSION)
+endif ()
+if (ENABLE_PARALLEL_SEARCH)
+    add_definitions(-DENABLE_PARALLEL_SEARCH)
+endif ()
+if (ENABLE_QUERY_CACHE)
+    add_definitions(-DENABLE_QUERY_CACHE)
+endif ()
+if (ENABLE_INCREMENTAL_SEARCH)
+    add_definitions(-DENABLE_INCREMENTAL_SEARCH)
+endif ()
+if (ENABLE_BATCH_RESOLUTION)
+    add_definitions(-DENABLE_BATCH_RESOLUTION)
+endif ()
+if (ENABLE_CONCURRENT_INGESTION)
+    add_definitions(-DENABLE_CONCURRENT_INGESTION)
+endif ()
+if (ENABLE_BATCHED_INGESTION)
+    add_definitions(-DENABLE_BATCHED_INGESTION)
+endif ()
+if (ENABLE_CONNECTION_ORDERING)
+    add_definitions(-DENABLE_CONNECTION_ORDERING)
+endif ()
+if (ENABLE_WRITE_AHEAD_LOG)
+    add_definitions(-DENABLE_WRITE_AHEAD_LOG)
+endif ()
+if (ENABLE_CELL_TILE_INDEX)
+    add_definitions(-DENABLE_CELL_TILE_INDEX)
+endif ()
+if (ENABLE_RADIX_QUEUE)
+    add_definitions(-DENABLE_RADIX_QUEUE)
+endif ()
+if (ENABLE_DARY_QUEUE)
+    add_definitions(-DENABLE_DARY_QUEUE)
+endif ()
@@ -7,6 +7,31 @@
 PrefixedLogger connectLogger = PrefixedLogger("[CONNECTION]", true);
 
 // Class definition -------------------------------------------------------------------------------
+static void waitUntil(atomic<uint64_t> &value, uint64_t target) {
+    for (uint64_t current = value.load(memory_order_acquire); current < target;
+         current = value.load(memory_order_acquire)) {
+        value.wait(current, memory_order_acquire);
+    }
+}
+
+bool RequestTicket::ready() const {
+    return !order || order->answered.load(memory_order_acquire) >= after;
+}
+
+void RequestTicket::waitReady() const {
+    if (order) waitUntil(order->answered, after);
+}
+
+void RequestTicket::waitTurn() const {
+    if (order) waitUntil(order->answered, sequence - 1);
+}
+
+void RequestTicket::markAnswered() const {
+    if (!order) return;
+    order->answered.store(sequence, memory_order_release);
+    order->answered.notify_all();
+}
+
 bool EpollConnectEntry::handleEvent(uint32_t events) {
     if (!this->is_fd_valid()) {
 #ifdef CONNECT_LOGGER
@@ -54,9 +79,15 @@ bool EpollConnectEntry::handleEvent(uint32_t events) {
 }
 
 void EpollConnectEntry::readEvent() {
+#ifdef ENABLE_CONNECTION_ORDERING
+    if (order->closing) {
+        return;
+    }
+#else
     if (processingInProgress) {
         return;
     }
+#endif
 
     // New message
     if (!messageInProgress) {
@@ -114,18 +145,47 @@ void EpollConnectEntry::readEvent() {
     processingInProgress = true;
     int fd = this->get_fd();
 
+    RequestTicket ticket;
+#ifdef ENABLE_CONNECTION_ORDERING
+    // Further requests are read meanwhile, the ticket orders them against this one. A write must not
+    // change the grid under the reads sent before it, so it waits for all of them
+    bool write = request.has_walk() || request.has_reset();
+    ticket = {order, ++lastSequence, write ? lastSequence - 1 : lastWriteSequence};
+    if (write) lastWriteSequence = ticket.sequence;
+    // Its task shuts the connection down, reading on would race with that for the descriptor
+    if (request.has_onetoall()) order->closing = true;
+#endif
+
     if (request.has_walk() || request.has_reset()) {
 //        processMessage(request, response, gridData, gridStats, fd);
 //        this->processingInProgress = false;
-        resourcePool.run([this, request, response, &gridData, &gridStats, fd] {
-            processMessage(request, response, gridData, gridStats, fd);
+#ifdef ENABLE_BATCHED_INGESTION
+        // The writer answers once the batch with the request is applied
+        IngestRequest ingest{std::move(request), [this, response, fd, ticket]() mutable {
+            writeResponse(response, fd);
+            ticket.markAnswered();
+            this->processingInProgress = false;
+        }};
+        if (ticket.ready()) {
+            ingestQueue.push(std::move(ingest));
+        } else {
+            // The writer must never wait for a connection, the request is queued once it may apply
+            resourcePool1.run([ingest = std::move(ingest), ticket]() mutable {
+                ticket.waitReady();
+                ingestQueue.push(std::move(ingest));
+            }, fd);
+        }
+#else
+        resourcePool.run([this, request, response, &gridData, &gridStats, fd, ticket] {
+            processMessage(request, response, gridData, gridStats, fd, ticket);
             this->processingInProgress = false;
         }, fd);
+#endif
     } else {
 //        processMessage(request, response, gridData, gridStats, fd);
 //        this->processingInProgress = false;
-        resourcePool1.run([this, request, response, gridData, gridStats, fd] {
-            processMessage(request, response, gridData, gridStats, fd);
+        resourcePool1.run([this, request, response, gridData, gridStats, fd, ticket] {
+            processMessage(request, response, gridData, gridStats, fd, ticket);
             this->processingInProgress = false;
         }, fd);
     }
@@ -164,13 +224,16 @@ int EpollConnectEntry::readMessageSize() {
     return msgSize;
 }
 
-void EpollConnectEntry::processMessage(esw::Request request, esw::Response response, GridData &gridData, GridStats &gridStats, int fd) {
+void EpollConnectEntry::processMessage(esw::Request request, esw::Response response, GridData &gridData, GridStats &gridStats, int fd,
+                                       const RequestTicket &ticket) {
+    ticket.waitReady();
     if (request.has_walk()) {
 #ifdef PROCESS_LOGGER
         connectLogger.warn("Walk message received on connection [FD%d]", fd);
 #endif
         const esw::Walk &walk = request.walk();
         processWalk(gridData, gridStats, walk);
+        publishWalks(gridData);
 
     } else if (request.has_onetoone()) {
 #ifdef PROCESS_LOGGER
@@ -194,11 +257,23 @@ void EpollConnectEntry::processMessage(esw::Request request, esw::Response respo
 #endif
         response.set_total_length(val);
 
+    } else if (request.has_manytomany()) {
+#ifdef PROCESS_LOGGER
+        connectLogger.warn("ManyToMany message received on connection [FD%d]", fd);
+#endif
+        const esw::ManyToMany &manyToMany = request.manytomany();
+        vector<uint64_t> distances = processManyToMany(gridData, gridStats, manyToMany);
+#ifdef PROCESS_LOGGER
+        connectLogger.info("ManyToMany response with %lu distances on connection [FD%d]", distances.size(), fd);
+#endif
+        response.mutable_distances()->Add(distances.begin(), distances.end());
+
     } else if (request.has_reset()) {
 #ifdef PROCESS_LOGGER
         connectLogger.warn("Reset message received on connection [FD%d]", fd);
 #endif
         processReset(gridData, gridStats);
+        publishWalks(gridData);
 
     } else {
 #ifdef PROCESS_LOGGER
@@ -208,7 +283,9 @@ void EpollConnectEntry::processMessage(esw::Request request, esw::Response respo
     }
 
     // Send the response
+    ticket.waitTurn();
     writeResponse(response, fd);
+    ticket.markAnswered();
 
     // Final request should close the connection
     if (request.has_onetoall()) {
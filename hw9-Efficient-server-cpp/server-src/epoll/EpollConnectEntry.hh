@@ -14,6 +14,7 @@
 #include <sstream>
 #include <memory>
 #include <functional>
+#include <atomic>
 
 #include "EpollEntry.hh"
 
@@ -31,6 +32,31 @@ extern GridData gridData;
 extern GridStats gridStats;
 
 // Class definition -------------------------------------------------------------------------------
+/**
+ * Order of the requests of one connection, shared with the tasks still processing them. A read waits
+ * only for the writes its own connection sent before it, a write for all the requests sent before it,
+ * and everything answers in the order it was sent, so connections never wait for unrelated traffic.
+ */
+struct ConnectionOrder {
+    atomic<uint64_t> answered{0};   // last request answered
+    bool closing = false;           // a OneToAll ending the connection was read, nothing is read after it
+};
+
+// Place of a request in the order of its connection, without an order it never waits
+struct RequestTicket {
+    shared_ptr<ConnectionOrder> order;
+    uint64_t sequence = 0;
+    uint64_t after = 0;             // last request that has to be answered before this one runs
+
+    bool ready() const;
+
+    void waitReady() const;
+
+    void waitTurn() const;
+
+    void markAnswered() const;
+};
+
 class EpollConnectEntry : public EpollEntry
 {
 private:
@@ -39,12 +65,16 @@ private:
     char            messageBuffer[50000];
     bool            messageInProgress;
     bool            processingInProgress;
+    shared_ptr<ConnectionOrder> order;
+    uint64_t        lastSequence;
+    uint64_t        lastWriteSequence;
 
     void readEvent();
 
     int readMessageSize();
 
-    void processMessage(esw::Request request, esw::Response response, GridData &gridData, GridStats &gridStats, int fd);
+    void processMessage(esw::Request request, esw::Response response, GridData &gridData, GridStats &gridStats, int fd,
+                        const RequestTicket &ticket);
 
     void writeResponse(esw::Response &response, int fd);
 
@@ -54,7 +84,10 @@ public:
             inProgressMessageSize(0),
             inProgressMessageOffset(0),
             messageInProgress(false),
-            processingInProgress(false) {
+            processingInProgress(false),
+            order(make_shared<ConnectionOrder>()),
+            lastSequence(0),
+            lastWriteSequence(0) {
 
         // Assign the file descriptor of the accepted connection
         this->set_fd(fd);
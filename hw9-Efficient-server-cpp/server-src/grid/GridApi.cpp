@@ -5,6 +5,7 @@
 //#define GRID_GRAPH_LOGGER
 //#define GRID_STATS_LOGGER
 //#define GRID_EDGE_LOGGER
+//#define GRID_MEMORY_LOGGER
 PrefixedLogger gridLogger = PrefixedLogger("[GRID      ]", true);
 
 // Class definition -------------------------------------------------------------------------------
@@ -24,13 +25,57 @@ uint64_t GridData::getPointCellId(Point &point) {
     uint64_t probableCoordY = point.y / 500;
 
     // Search whether there isn't a better match
+#ifdef ENABLE_CELL_TILE_INDEX
+    CellTileIndex::Cursor cursor;
+#endif
     for (const auto &comb: precomputedNeighbourPairs) {
         uint64_t neighborCellId = ((probableCoordX + comb.first) << 32) | (probableCoordY + comb.second);
+#ifdef ENABLE_CELL_TILE_INDEX
+        if (cellIndex.find(neighborCellId, cursor) == NO_CELL) continue; // The searched cell does not exist
+
+        const Point &neighborPoint = cellIndex.point(neighborCellId, cursor);
+        const uint64_t &neighborPointX = neighborPoint.x;
+        const uint64_t &neighborPointY = neighborPoint.y;
+#else
         auto cellIt = cells[neighborCellId % CHUNKS].find(neighborCellId);
         if (cellIt == cells[neighborCellId % CHUNKS].end()) continue; // The searched cell does not exist
 
-        const uint64_t &neighborPointX = cellIt->second.pointX;
-        const uint64_t &neighborPointY = cellIt->second.pointY;
+        const Point neighborPoint = cellIt->second.point();
+        const uint64_t &neighborPointX = neighborPoint.x;
+        const uint64_t &neighborPointY = neighborPoint.y;
+#endif
+        uint64_t dx = (point.x > neighborPointX) ? (point.x - neighborPointX) : (neighborPointX - point.x);
+        uint64_t dy = (point.y > neighborPointY) ? (point.y - neighborPointY) : (neighborPointY - point.y);
+        if ((dx * dx + dy * dy) <= 250000) {
+            return neighborCellId;
+        }
+    }
+
+    return ((probableCoordX << 32) | (probableCoordY));
+}
+
+uint32_t GridData::getCellIndex(uint64_t cellId) {
+#ifdef ENABLE_CELL_TILE_INDEX
+    return cellIndex.find(cellId);
+#else
+    auto cellIt = cells[cellId % CHUNKS].find(cellId);
+    if (cellIt == cells[cellId % CHUNKS].end()) return NO_CELL;
+    return cellIt->second.index;
+#endif
+}
+
+uint64_t GridSnapshot::getPointCellId(const Point &point) const {
+    uint64_t probableCoordX = point.x / 500;
+    uint64_t probableCoordY = point.y / 500;
+
+    for (const auto &comb: precomputedNeighbourPairs) {
+        uint64_t neighborCellId = ((probableCoordX + comb.first) << 32) | (probableCoordY + comb.second);
+        uint32_t index = getCellIndex(neighborCellId);
+        if (index == NO_CELL) continue; // The searched cell does not exist
+
+        // The points hold the coordinates of the cells exactly, they are sign-extended like in Cell::point
+        uint64_t neighborPointX = static_cast<uint64_t>(static_cast<int64_t>(graph.point(index).x));
+        uint64_t neighborPointY = static_cast<uint64_t>(static_cast<int64_t>(graph.point(index).y));
         uint64_t dx = (point.x > neighborPointX) ? (point.x - neighborPointX) : (neighborPointX - point.x);
         uint64_t dy = (point.y > neighborPointY) ? (point.y - neighborPointY) : (neighborPointY - point.y);
         if ((dx * dx + dy * dy) <= 250000) {
@@ -41,22 +86,49 @@ uint64_t GridData::getPointCellId(Point &point) {
     return ((probableCoordX << 32) | (probableCoordY));
 }
 
+uint32_t GridSnapshot::getCellIndex(uint64_t cellId) const {
+    return cellIndex.find(cellId);
+}
+
+void CellTileIndex::insert(uint64_t cellId, uint32_t index, const Point &point) {
+    auto [found, added] = entries.try_emplace(tileKey(cellId), TileEntry{static_cast<uint32_t>(tiles.size()), 0});
+    if (added) tiles.emplace_back();
+
+    uint32_t slot = slotOf(cellId);
+    found->second.occupied |= 1u << slot;
+    tiles[found->second.position].slots[slot] = {index, point};
+}
+
 void GridData::addPoint(GridStats &gridStats, Point &point, uint64_t &cellId) {
     gridStats.location_count++;
 
+#ifdef ENABLE_CELL_TILE_INDEX
+    if (cellIndex.find(cellId) == NO_CELL) {
+#else
     auto it = cells[cellId % CHUNKS].find(cellId);
 
     if (it == cells[cellId % CHUNKS].end()) {
+#endif
         uint64_t coordX = point.x / 500;
         uint64_t coordY = point.y / 500;
         uint64_t id = ((coordX << 32) | coordY);
 
-        vector<Edge> newEdges = vector<Edge>();
-        newEdges.reserve(5);
-        vector<Edge> newInEdges = vector<Edge>();
-        newInEdges.reserve(5);
-        Cell newCell = {id, coordX, coordY, point.x, point.y, newEdges, newInEdges};
-        cells[cellId % CHUNKS][id] = newCell;
+        uint32_t index;
+        {
+#ifdef ENABLE_CONCURRENT_INGESTION
+            // Writers of other chunks add cells at the same time
+            lock_guard<mutex> lock(cellIdsMutex);
+#endif
+            index = cellIds.size();
+            cellIds.push_back(id);
+        }
+        // Edges start inline, a cell allocates only beyond CELL_INLINE_EDGES per direction
+        Cell newCell = {index, static_cast<int32_t>(point.x), static_cast<int32_t>(point.y), {}, {}};
+        cells[cellId % CHUNKS][id] = std::move(newCell);
+#ifdef ENABLE_CELL_TILE_INDEX
+        cellIndex.insert(id, index, point);
+#endif
+        version++;
 
         gridStats.quad[cellId % CHUNKS]++;
 
@@ -77,32 +149,70 @@ void GridData::addPoint(GridStats &gridStats, Point &point, uint64_t &cellId) {
     }
 }
 
-void GridData::addEdge(GridStats &gridStats, uint64_t &originCellId, uint64_t &destinationCellId, uint64_t length) {
-    for (auto &[id, len, samples]: cells[originCellId % CHUNKS][originCellId].edges) {
-        if (id == destinationCellId) {
-            len += length;
-            samples++;
-            return;
+void EdgeIndex::append(EdgeList &edges, uint32_t cellIndex, const Edge &edge) {
+    edges.push_back(edge);
+    if (edges.size() == EDGE_INDEX_DEGREE + 1) {
+        // The list outgrew scanning, index all of its edges
+        for (uint32_t position = 0; position < edges.size(); position++) {
+            positions[arcKey(cellIndex, edges.begin()[position].index)] = position;
         }
+    } else if (edges.size() > EDGE_INDEX_DEGREE + 1) {
+        positions[arcKey(cellIndex, edge.index)] = edges.size() - 1;
     }
-    for (auto &[id, len, samples]: cells[destinationCellId % CHUNKS][destinationCellId].inEdges) {
-        if (id == originCellId) {
-            len += length;
-            samples++;
-            return;
+}
+
+void GridData::addEdge(GridStats &gridStats, uint64_t &originCellId, uint64_t &destinationCellId, uint64_t length) {
+    version++;
+    Cell &origin = cells[originCellId % CHUNKS][originCellId];
+    Cell &destination = cells[destinationCellId % CHUNKS][destinationCellId];
+
+    // Both directions carry the same averages so the reverse adjacency can be searched too
+    Edge *edge = edgeIndex[originCellId % CHUNKS].find(origin.edges, origin.index, destination.index);
+    if (edge) {
+        Edge *inEdge = inEdgeIndex[destinationCellId % CHUNKS].find(destination.inEdges, destination.index,
+                                                                     origin.index);
+<<<<<<< HEAD
+=======
+#if defined(ENABLE_INCREMENTAL_SEARCH) || defined(ENABLE_LANDMARK_SEARCH)
+>>>>>>> e4b7306 ([user-021] Add an ALT landmark index for OneToOne search)
+        if (edge->length / edge->samples != (edge->length + length) / (edge->samples + 1)) {
+#ifdef ENABLE_INCREMENTAL_SEARCH
+            recordEdgeChange(origin.index, destination.index, edge->length / edge->samples);
+#endif
+            recordArcChange(origin.index, destination.index);
         }
+        edge->length += length;
+        edge->samples++;
+        inEdge->length += length;
+        inEdge->samples++;
+        return;
     }
 
     gridStats.edges_count++;
-    cells[originCellId % CHUNKS][originCellId].edges.push_back({destinationCellId, length, 1});
-    cells[destinationCellId % CHUNKS][destinationCellId].inEdges.push_back({originCellId, length, 1});
+#if defined(ENABLE_INCREMENTAL_SEARCH) || defined(ENABLE_LANDMARK_SEARCH)
+    recordEdgeChange(origin.index, destination.index, NEW_ARC);
+#endif
+    recordArcChange(origin.index, destination.index);
+    edgeIndex[originCellId % CHUNKS].append(origin.edges, origin.index, {destination.index, 1, length});
+    inEdgeIndex[destinationCellId % CHUNKS].append(destination.inEdges, destination.index, {origin.index, 1, length});
 }
 
 void GridData::resetGrid(GridStats &gridStats) {
     for (int i = 0; i < CHUNKS; i++) {
         cells[i].clear();
+        edgeIndex[i].clear();
+        inEdgeIndex[i].clear();
         gridStats.quad[i] = 0;
     }
+    cellIds.clear();
+    cellIndex.clear();
+    version++;
+    queryCache.clear();
+    pathTrees.clear();
+    edgeChanges.clear();
+    edgeChangesSince = version;
+    changedArcs.clear();
+    layoutChanged = true;
 
     gridStats.edges_count = 0;
     gridStats.highestCoordX = {numeric_limits<uint64_t>::min(), 0};
@@ -113,18 +223,45 @@ void GridData::resetGrid(GridStats &gridStats) {
     gridStats.walk_count = 0;
     gridStats.oneToOne_count = 0;
     gridStats.oneToAll_count = 0;
+    gridStats.manyToMany_count = 0;
     gridStats.location_count = 0;
 }
 
+void GridData::recordEdgeChange(uint32_t originIndex, uint32_t destinationIndex, uint64_t oldWeight) {
+#ifdef ENABLE_CONCURRENT_INGESTION
+    // Versions read under the lock keep the log ordered, each is past the increment of its own edge
+    lock_guard<mutex> lock(edgeChangesMutex);
+#endif
+    edgeChanges.push_back({version, originIndex, destinationIndex, oldWeight});
+
+    // Trees older than the kept half of the log are rebuilt from scratch anyway
+    if (edgeChanges.size() > 2 * INCREMENTAL_MAX_CHANGES) {
+        edgeChangesSince = edgeChanges.trim(INCREMENTAL_MAX_CHANGES);
+    }
+}
+
+void GridData::recordArcChange(uint32_t originIndex, uint32_t destinationIndex) {
+#ifdef ENABLE_CONCURRENT_INGESTION
+    lock_guard<mutex> lock(edgeChangesMutex);
+#endif
+    if (layoutChanged) return;
+    changedArcs.push_back({originIndex, destinationIndex});
+    if (changedArcs.size() > PUBLISH_MAX_CHANGES) {
+        changedArcs.clear();
+        layoutChanged = true;
+    }
+}
+
 void GridData::logGridGraph() {
 #ifdef GRID_GRAPH_LOGGER
     // Log information about cells
-    gridLogger.info("Grid contains %lu cells:", cells.size());
-    for (const auto& [cellId, cell] : cells) {
-        gridLogger.info("Cell %lu: Coord(%lu, %lu), Point(%lu, %lu)",
-                        cell.id, cell.coordX, cell.coordY, cell.pointX, cell.pointY);
-        for (const auto& [id, edge] : cell.edges) {
-            gridLogger.info("  with Edge to Cell %lu edge: %lu", id, edge.length / edge.samples);
+    gridLogger.info("Grid contains %lu cells:", cellIds.size());
+    for (const auto& cellId : cellIds) {
+        const Cell &cell = cells[cellId % CHUNKS].find(cellId)->second;
+        gridLogger.info("Cell %lu: Coord(%lu, %lu), Point(%d, %d)",
+                        cellId, cellId >> 32, cellId & 0xFFFFFFFF, cell.pointX, cell.pointY);
+        for (const auto& edge : cell.edges) {
+            gridLogger.info("  with Edge to Cell %lu edge: %lu", cellIds[edge.index], edge.length / edge.samples);
         }
     }
 #endif
@@ -143,14 +280,64 @@ void GridData::logGridGraph() {
 #endif
 }
 
+template<typename T>
+static size_t vectorBytes(const vector<T> &elements) {
+    return elements.capacity() * sizeof(T);
+}
+
+GridMemory GridData::memoryUsage() {
+    GridMemory memory = {};
+    for (const auto &batch: cells) {
+        memory.cells += vectorBytes(batch.values()) +
+                        batch.bucket_count() * sizeof(ankerl::unordered_dense::bucket_type::standard);
+        for (const auto &[cellId, cell]: batch) {
+            memory.cellCount++;
+            memory.edgeCount += cell.edges.size();
+            memory.spilledEdges += cell.edges.heapBytes() + cell.inEdges.heapBytes();
+            if (cell.edges.heapBytes() + cell.inEdges.heapBytes() > 0) memory.spilledCells++;
+        }
+    }
+    memory.cellIds = vectorBytes(cellIds);
+    memory.cellIndex = cellIndex.memoryUsage();
+    for (int i = 0; i < CHUNKS; i++) {
+        memory.edgeIndex += edgeIndex[i].memoryUsage() + inEdgeIndex[i].memoryUsage();
+    }
+    // The snapshots share the blocks of the log
+    memory.edgeChanges = edgeChanges.memoryUsage();
+
+    shared_ptr<const GridSnapshot> current = snapshot.load(memory_order_acquire);
+    const GridGraph &graph = current->graph;
+    memory.graph = graph.memoryUsage() + current->cellIndex.memoryUsage();
+    if (const ChainGraph *chainGraph = current->builtChainGraph()) {
+        memory.chainGraph = vectorBytes(chainGraph->offsets) + vectorBytes(chainGraph->arcs) +
+                            vectorBytes(chainGraph->interiorCounts) + vectorBytes(chainGraph->interiorOffsets) +
+                            vectorBytes(chainGraph->chainOf) + vectorBytes(chainGraph->memberOf) +
+                            vectorBytes(chainGraph->chainStarts) + vectorBytes(chainGraph->chainHeads) +
+                            vectorBytes(chainGraph->members) + vectorBytes(chainGraph->memberOffsets);
+    }
+    return memory;
+}
+
+void GridData::logGridMemory() {
+#ifdef GRID_MEMORY_LOGGER
+    GridMemory memory = memoryUsage();
+    gridLogger.info("Memory of %lu cells and %lu edges: %lu bytes", memory.cellCount, memory.edgeCount,
+                    memory.total());
+    gridLogger.info("  Cells: %lu Spilled edges: %lu in %lu cells Cell ids: %lu Cell index: %lu", memory.cells,
+                    memory.spilledEdges, memory.spilledCells, memory.cellIds, memory.cellIndex);
+    gridLogger.info("  Edge index: %lu Edge changes: %lu Graph: %lu Chain graph: %lu", memory.edgeIndex,
+                    memory.edgeChanges, memory.graph, memory.chainGraph);
+#endif
+}
+
 void GridStats::logGridStats() {
 #ifdef GRID_STATS_LOGGER
-    gridLogger.info("  Edges count: %lu", edges_count);
+    gridLogger.info("  Edges count: %lu", edges_count.load());
     gridLogger.info("  Highest X: %lu, %lu", highestCoordX.first, highestCoordX.second);
     gridLogger.info("  Highest Y: %lu, %lu", highestCoordY.first, highestCoordY.second);
     gridLogger.info("  Lowest X: %lu, %lu", lowestCoordX.first, lowestCoordX.second);
     gridLogger.info("  Lowest Y: %lu, %lu", lowestCoordY.first, lowestCoordY.second);
 #endif
-    gridLogger.info("  Walks: %lu OneToOne: %lu OneToAll: %lu Locations: %lu", walk_count, oneToOne_count,
-                    oneToAll_count, location_count);
+    gridLogger.info("  Walks: %lu OneToOne: %lu OneToAll: %lu ManyToMany: %lu Locations: %lu", walk_count.load(),
+                    oneToOne_count.load(), oneToAll_count.load(), manyToMany_count.load(), location_count.load());
 }
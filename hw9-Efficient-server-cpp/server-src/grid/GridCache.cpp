@@ -0,0 +1,74 @@
+
+#include "GridCache.hh"
+#include "Logger.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define CACHE_STATS_LOGGER
+PrefixedLogger cacheLogger = PrefixedLogger("[CACHE     ]", true);
+
+// Class definition -------------------------------------------------------------------------------
+QueryCache::QueryCache(size_t capacity) :
+        shards(QUERY_CACHE_SHARDS),
+        shardCapacity(max<size_t>(1, capacity / QUERY_CACHE_SHARDS)),
+        hits(0),
+        misses(0)
+{
+}
+
+uint64_t QueryCache::getOrCompute(const QueryKey &key, uint64_t version, const function<uint64_t()> &search) {
+    uint64_t hash = QueryKeyHash()(key);
+    Shard &shard = shards[hash % QUERY_CACHE_SHARDS];
+
+    promise<uint64_t> pending;
+    shared_future<uint64_t> result;
+    bool outdated = false;
+    {
+        lock_guard<mutex> lock(shard.lock);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+            if (found->second->version == version) {
+                result = found->second->result;
+            } else if (found->second->version > version) {
+                // A query of an older snapshot does not evict the newer result
+                outdated = true;
+            } else {
+                // Results of older versions are replaced in place
+                found->second->version = version;
+                found->second->result = pending.get_future().share();
+            }
+        } else {
+            shard.entries.push_front({key, version, pending.get_future().share()});
+            shard.index[key] = shard.entries.begin();
+            if (shard.entries.size() > shardCapacity) {
+                shard.index.erase(shard.entries.back().key);
+                shard.entries.pop_back();
+            }
+        }
+    }
+
+    // Hits wait for a search still in flight outside of the shard lock
+    if (result.valid()) {
+        hits.fetch_add(1, memory_order_relaxed);
+        return result.get();
+    }
+
+    misses.fetch_add(1, memory_order_relaxed);
+    uint64_t value = search();
+    if (!outdated) pending.set_value(value);
+    return value;
+}
+
+void QueryCache::clear() {
+    for (auto &shard: shards) {
+        lock_guard<mutex> lock(shard.lock);
+        shard.entries.clear();
+        shard.index.clear();
+    }
+}
+
+void QueryCache::logCacheStats() {
+#ifdef CACHE_STATS_LOGGER
+    cacheLogger.info("Query cache hits: %lu misses: %lu", hits.load(), misses.load());
+#endif
+}
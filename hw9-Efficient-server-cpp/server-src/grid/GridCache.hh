@@ -0,0 +1,80 @@
+#ifndef GRID_CACHE_HH
+#define GRID_CACHE_HH
+
+#include <list>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "unordered_dense.h"
+
+// Global variables -------------------------------------------------------------------------------
+// Cached query results over all shards
+#ifndef QUERY_CACHE_CAPACITY
+#define QUERY_CACHE_CAPACITY 65536
+#endif
+
+#define QUERY_CACHE_SHARDS 16
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+// Query resolved to cells, OneToAll queries have no destination
+struct QueryKey {
+    uint64_t originCellId;
+    uint64_t destinationCellId;
+    bool oneToAll;
+
+    bool operator==(const QueryKey &other) const {
+        return originCellId == other.originCellId && destinationCellId == other.destinationCellId &&
+               oneToAll == other.oneToAll;
+    }
+};
+
+struct QueryKeyHash {
+    using is_avalanching = void;
+
+    uint64_t operator()(const QueryKey &key) const {
+        uint64_t origin = ankerl::unordered_dense::detail::wyhash::hash(key.originCellId);
+        return ankerl::unordered_dense::detail::wyhash::mix(origin ^ key.oneToAll, key.destinationCellId);
+    }
+};
+
+/**
+ * Concurrent LRU cache of query results, sharded by the query. An entry is valid only for the grid
+ * version it was computed at, so any change of the grid invalidates all entries at once. Identical
+ * queries arriving while the first one is still searching wait for its result instead of searching.
+ */
+class QueryCache {
+private:
+    struct Entry {
+        QueryKey key;
+        uint64_t version;
+        shared_future<uint64_t> result;     // not ready while the search is in flight
+    };
+
+    struct Shard {
+        mutex lock;
+        list<Entry> entries;                // most recently used first
+        ankerl::unordered_dense::map<QueryKey, list<Entry>::iterator, QueryKeyHash> index;
+    };
+
+    vector<Shard> shards;
+    size_t shardCapacity;
+    atomic<uint64_t> hits;
+    atomic<uint64_t> misses;
+public:
+    QueryCache(size_t capacity = QUERY_CACHE_CAPACITY);
+
+    // Returns the cached result of the query at the version, runs the search only on a miss
+    uint64_t getOrCompute(const QueryKey &key, uint64_t version, const function<uint64_t()> &search);
+
+    void clear();
+
+    void logCacheStats();
+};
+
+#endif //GRID_CACHE_HH
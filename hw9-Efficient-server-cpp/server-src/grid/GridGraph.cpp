@@ -0,0 +1,390 @@
+
+#include "GridModel.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define GRAPH_BUILD_LOGGER
+PrefixedLogger graphLogger = PrefixedLogger("[GRAPH     ]", true);
+
+// Class definition -------------------------------------------------------------------------------
+/**
+ * Lays out one direction of the cells of a block. Kept cells no change touched copy their arc ranges from
+ * the previous block, the changed and appended cells emit their current edge lists.
+ */
+template<typename Emit>
+static shared_ptr<const ArcBlock> layoutBlock(uint32_t block, uint32_t size, const ArcBlock *previous,
+                                              uint32_t kept, span<const uint32_t> changed, const Emit &emit) {
+    auto next = make_shared<ArcBlock>();
+    uint32_t first = block << GRAPH_BLOCK_BITS;
+    uint32_t last = min(size, first + GRAPH_BLOCK_SIZE);
+    if (previous) next->arcs.reserve(previous->arcs.size() + changed.size());
+
+    auto change = changed.begin();
+    next->offsets[0] = 0;
+    for (uint32_t index = first; index < last; index++) {
+        uint32_t cell = index - first;
+        if (index < kept && (change == changed.end() || *change != index)) {
+            next->arcs.insert(next->arcs.end(), previous->arcs.begin() + previous->offsets[cell],
+                              previous->arcs.begin() + previous->offsets[cell + 1]);
+        } else {
+            if (index < kept) change++;
+            emit(index, next->arcs);
+        }
+        next->offsets[cell + 1] = next->arcs.size();
+    }
+    fill(next->offsets + (last - first) + 1, next->offsets + GRAPH_BLOCK_SIZE + 1, next->arcs.size());
+    return next;
+}
+
+/**
+ * Lays out one direction of the graph from the previous one of the kept cells. The blocks holding neither
+ * a changed nor an appended cell are shared, the others are laid out again.
+ */
+template<typename Emit>
+static void relayout(const vector<shared_ptr<const ArcBlock>> &previousBlocks, uint32_t kept,
+                     const vector<uint32_t> &changed, uint32_t size, vector<shared_ptr<const ArcBlock>> &blocks,
+                     size_t &arcTotal, const Emit &emit) {
+    blocks = previousBlocks;
+    blocks.resize((size + GRAPH_BLOCK_SIZE - 1) >> GRAPH_BLOCK_BITS);
+    auto replace = [&](uint32_t block, span<const uint32_t> cells) {
+        const ArcBlock *previous = blocks[block].get();
+        if (previous) arcTotal -= previous->arcs.size();
+        blocks[block] = layoutBlock(block, size, previous, kept, cells, emit);
+        arcTotal += blocks[block]->arcs.size();
+    };
+
+    // The changed cells are kept ones, those of the first block with appended cells are laid out with them
+    uint32_t appended = size > kept ? kept >> GRAPH_BLOCK_BITS : blocks.size();
+    auto begin = changed.begin();
+    for (uint32_t block = 0; begin != changed.end() && (block = *begin >> GRAPH_BLOCK_BITS) < appended;) {
+        auto end = find_if(begin, changed.end(), [block](uint32_t index) { return index >> GRAPH_BLOCK_BITS != block; });
+        replace(block, {begin, end});
+        begin = end;
+    }
+    for (uint32_t block = appended; block < blocks.size(); block++) {
+        replace(block, {begin, changed.end()});
+        begin = changed.end();
+    }
+}
+
+// Emits the averaged arcs of a cell of the grid in one direction
+static auto emitArcs(GridData &gridData, bool reverse) {
+    return [&gridData, reverse](uint32_t index, vector<GraphArc> &arcs) {
+        uint64_t cellId = gridData.cellIds[index];
+        const Cell &cell = gridData.cells[cellId % CHUNKS].find(cellId)->second;
+        for (const auto &[neighbour, samples, len]: reverse ? cell.inEdges : cell.edges) {
+            arcs.push_back({neighbour, static_cast<uint32_t>(len / samples)});
+        }
+    };
+}
+
+// Lays out the points of the appended cells, the first block with appended cells is copied
+static void appendPoints(vector<shared_ptr<const PointBlock>> &blocks, uint32_t kept, GridData &gridData) {
+    uint32_t size = gridData.cellIds.size();
+    blocks.resize((size + GRAPH_BLOCK_SIZE - 1) >> GRAPH_BLOCK_BITS);
+    for (uint32_t block = kept >> GRAPH_BLOCK_BITS; block < blocks.size(); block++) {
+        auto next = blocks[block] ? make_shared<PointBlock>(*blocks[block]) : make_shared<PointBlock>();
+        uint32_t first = block << GRAPH_BLOCK_BITS;
+        for (uint32_t index = max(kept, first); index < min(size, first + GRAPH_BLOCK_SIZE); index++) {
+            uint64_t cellId = gridData.cellIds[index];
+            const Cell &cell = gridData.cells[cellId % CHUNKS].find(cellId)->second;
+            next->points[index - first] = {static_cast<double>(cell.pointX), static_cast<double>(cell.pointY)};
+        }
+        blocks[block] = std::move(next);
+    }
+}
+
+void GridGraph::build(GridData &gridData) {
+    // Lay out the adjacency in cell index order
+    cells = gridData.cellIds.size();
+    arcTotal = 0;
+    relayout({}, 0, {}, cells, arcBlocks, arcTotal, emitArcs(gridData, false));
+    size_t reverseTotal = 0;
+    relayout({}, 0, {}, cells, reverseArcBlocks, reverseTotal, emitArcs(gridData, true));
+    pointBlocks.clear();
+    appendPoints(pointBlocks, 0, gridData);
+
+    /**
+     * Arc lengths are measured between the original locations, not the representative points, and the
+     * snapping error of up to 500 * sqrt(2) mm per endpoint accumulates along a path. A fixed Euclidean
+     * bound minus the snapping error is therefore not admissible over several hops. Scaling the distance
+     * by the lowest length per millimetre over all arcs is: h(u) <= w(u, v) + h(v) holds on every arc.
+     */
+    heuristicScale = 1.0;
+    minWeight = numeric_limits<uint32_t>::max();
+    for (uint32_t index = 0; index < size(); index++) {
+        for (const auto &[target, weight]: arcsOf(index)) {
+            minWeight = min(minWeight, weight);
+            double dx = point(index).x - point(target).x;
+            double dy = point(index).y - point(target).y;
+            double distance = sqrt(dx * dx + dy * dy);
+            if (distance > 0) {
+                heuristicScale = min(heuristicScale, weight / distance);
+            }
+        }
+    }
+    heuristicScale *= HEURISTIC_MARGIN;
+
+    version = gridData.version;
+#ifdef GRAPH_BUILD_LOGGER
+    graphLogger.debug("Graph built with %lu nodes and %lu arcs at version %lu", size(), arcCount(), version);
+    graphLogger.debug("Heuristic scale %f", heuristicScale);
+#endif
+}
+
+void GridGraph::update(const GridGraph &previous, GridData &gridData, const vector<ChangedArc> &changes) {
+    cells = gridData.cellIds.size();
+    uint32_t kept = previous.size();
+    vector<uint32_t> tails;
+    vector<uint32_t> heads;
+    for (const auto &[tail, head]: changes) {
+        if (tail < kept) tails.push_back(tail);
+        if (head < kept) heads.push_back(head);
+    }
+    sort(tails.begin(), tails.end());
+    tails.erase(unique(tails.begin(), tails.end()), tails.end());
+    sort(heads.begin(), heads.end());
+    heads.erase(unique(heads.begin(), heads.end()), heads.end());
+
+    arcTotal = previous.arcTotal;
+    relayout(previous.arcBlocks, kept, tails, cells, arcBlocks, arcTotal, emitArcs(gridData, false));
+    size_t reverseTotal = previous.arcTotal;
+    relayout(previous.reverseArcBlocks, kept, heads, cells, reverseArcBlocks, reverseTotal, emitArcs(gridData, true));
+    pointBlocks = previous.pointBlocks;
+    appendPoints(pointBlocks, kept, gridData);
+
+    // Unchanged arcs keep the bounds of the previous graph, a reweighted arc may only lower them
+    double scale = 1.0;
+    minWeight = previous.minWeight;
+    auto bound = [&](uint32_t index) {
+        for (const auto &[target, weight]: arcsOf(index)) {
+            minWeight = min(minWeight, weight);
+            double dx = point(index).x - point(target).x;
+            double dy = point(index).y - point(target).y;
+            double distance = sqrt(dx * dx + dy * dy);
+            if (distance > 0) {
+                scale = min(scale, weight / distance);
+            }
+        }
+    };
+    for (uint32_t index: tails) bound(index);
+    for (uint32_t index = kept; index < cells; index++) bound(index);
+    heuristicScale = min(previous.heuristicScale, scale * HEURISTIC_MARGIN);
+
+    version = gridData.version;
+#ifdef GRAPH_BUILD_LOGGER
+    graphLogger.debug("Graph updated with %u changed and %u appended cells at version %lu", tails.size(),
+                      cells - kept, version);
+#endif
+}
+
+size_t GridGraph::memoryUsage() const {
+    size_t bytes = (arcBlocks.capacity() + reverseArcBlocks.capacity()) * sizeof(shared_ptr<const ArcBlock>) +
+                   pointBlocks.capacity() * sizeof(shared_ptr<const PointBlock>) + pointBlocks.size() * sizeof(PointBlock);
+    for (const auto *blocks: {&arcBlocks, &reverseArcBlocks}) {
+        for (const auto &block: *blocks) {
+            bytes += sizeof(ArcBlock) + block->arcs.capacity() * sizeof(GraphArc);
+        }
+    }
+    return bytes;
+}
+
+void ChainGraph::build(const GridGraph &graph) {
+    uint32_t n = graph.size();
+    offsets.assign(1, 0);
+    arcs.clear();
+    interiorCounts.assign(n, 0);
+    interiorOffsets.assign(n, 0);
+    chainOf.assign(n, NO_CELL);
+    memberOf.assign(n, NO_CELL);
+    chainStarts.assign(1, 0);
+    chainHeads.clear();
+    members.clear();
+    memberOffsets.clear();
+
+    auto interior = [&graph](uint32_t index) {
+        return graph.arcsOf(index).size() == 1 && graph.reverseArcsOf(index).size() == 1;
+    };
+
+    // Follow every out-arc of every junction through the interior cells to the next junction
+    offsets.reserve(n + 1);
+    for (uint32_t index = 0; index < n; index++) {
+        if (!interior(index)) {
+            for (const GraphArc &arc: graph.arcsOf(index)) {
+                uint32_t target = arc.target;
+                uint64_t weight = arc.weight;
+                if (!interior(target)) {
+                    arcs.push_back({target, weight});
+                    continue;
+                }
+
+                uint32_t chain = chainHeads.size();
+                chainHeads.push_back(index);
+                while (interior(target)) {
+                    chainOf[target] = chain;
+                    memberOf[target] = members.size();
+                    members.push_back(target);
+                    memberOffsets.push_back(weight);
+                    interiorCounts[index]++;
+                    interiorOffsets[index] += weight;
+
+                    const GraphArc &next = graph.arcsOf(target)[0];
+                    target = next.target;
+                    weight += next.weight;
+                }
+                chainStarts.push_back(members.size());
+                arcs.push_back({target, weight});
+            }
+        }
+        offsets.push_back(arcs.size());
+    }
+
+    // Interior cells left over form cycles without any junction
+    for (uint32_t index = 0; index < n; index++) {
+        if (!interior(index) || chainOf[index] != NO_CELL) continue;
+
+        uint32_t chain = chainHeads.size();
+        chainHeads.push_back(NO_CELL);
+        uint32_t member = index;
+        uint64_t weight = 0;
+        do {
+            chainOf[member] = chain;
+            memberOf[member] = members.size();
+            members.push_back(member);
+            memberOffsets.push_back(weight);
+
+            const GraphArc &next = graph.arcsOf(member)[0];
+            member = next.target;
+            weight += next.weight;
+        } while (member != index);
+        chainStarts.push_back(members.size());
+    }
+
+    uint64_t totalWeight = 0;
+    for (const auto &arc: arcs) {
+        totalWeight += arc.weight;
+    }
+    meanWeight = arcs.empty() ? 1 : max<uint64_t>(1, totalWeight / arcs.size());
+
+    version = graph.version;
+#ifdef GRAPH_BUILD_LOGGER
+    graphLogger.debug("Chain graph built with %lu junctions, %lu chains and %lu arcs at version %lu",
+                      n - members.size(), chainHeads.size(), arcs.size(), version);
+#endif
+}
+
+ChainOrigin ChainGraph::locate(const GridGraph &graph, uint32_t originIndex) const {
+    if (!isInterior(originIndex)) {
+        return {originIndex, 0, NO_CELL, 0, 0, 0};
+    }
+
+    ChainOrigin origin = {NO_CELL, 0, chainHeads[chainOf[originIndex]], 0, 0, 0};
+
+    // A cycle without junctions is only reachable along itself
+    if (origin.head == NO_CELL) {
+        uint64_t dist = 0;
+        uint32_t member = originIndex;
+        do {
+            origin.sum += dist;
+            const GraphArc &next = graph.arcsOf(member)[0];
+            member = next.target;
+            dist += next.weight;
+        } while (member != originIndex);
+        return origin;
+    }
+
+    // The rest of the origin chain is reached from the origin only, it continues at the chain end
+    uint32_t first = memberOf[originIndex];
+    uint32_t last = chainStarts[chainOf[originIndex] + 1] - 1;
+    uint64_t base = memberOffsets[first];
+    for (uint32_t member = first; member <= last; member++) {
+        origin.tailCount++;
+        origin.tailOffsets += memberOffsets[member];
+        origin.sum += memberOffsets[member] - base;
+    }
+
+    const GraphArc &exit = graph.arcsOf(members[last])[0];
+    origin.junction = exit.target;
+    origin.distance = memberOffsets[last] - base + exit.weight;
+    return origin;
+}
+
+shared_ptr<const GridSnapshot> GridData::publishSnapshot() {
+    // Concurrent publishers race for the build, the first one publishes the walks of all of them
+    lock_guard<mutex> lock(snapshotMutex);
+    shared_ptr<const GridSnapshot> current = snapshot.load(memory_order_relaxed);
+    if (current->version == version) return current;
+
+    // The previous snapshot is the base of the changes since, unless the cells were renumbered or reset
+    auto next = make_shared<GridSnapshot>();
+    uint32_t kept = 0;
+    if (!layoutChanged && current->graph.size() > 0) {
+        next->graph.update(current->graph, *this, changedArcs);
+        next->cellIndex = current->cellIndex;
+        kept = current->graph.size();
+    } else {
+        next->graph.build(*this);
+    }
+    changedArcs.clear();
+    layoutChanged = false;
+    next->version = version;
+    next->cellIndex.append(cellIds, kept);
+    next->edgeChanges = edgeChanges;
+    next->edgeChangesSince = edgeChangesSince;
+    snapshot.store(next, memory_order_release);
+    return next;
+}
+
+void SnapshotCellIndex::append(const vector<uint64_t> &cellIds, uint32_t first) {
+    if (chunks.empty()) {
+        chunks.resize(1u << SNAPSHOT_INDEX_BITS);
+        for (auto &chunk: chunks) chunk = make_shared<Chunk>();
+    }
+    vector<bool> copied(chunks.size());
+    for (uint32_t index = first; index < cellIds.size(); index++) {
+        uint32_t chunk = chunkOf(cellIds[index]);
+        if (!copied[chunk]) {
+            chunks[chunk] = make_shared<Chunk>(*chunks[chunk]);
+            copied[chunk] = true;
+        }
+        if (chunks[chunk]->emplace(cellIds[index], index).second) count++;
+    }
+}
+
+size_t SnapshotCellIndex::memoryUsage() const {
+    size_t bytes = chunks.capacity() * sizeof(shared_ptr<Chunk>);
+    for (const auto &chunk: chunks) {
+        bytes += sizeof(Chunk) + chunk->values().capacity() * sizeof(pair<uint64_t, uint32_t>) +
+                 chunk->bucket_count() * sizeof(ankerl::unordered_dense::bucket_type::standard);
+    }
+    return bytes;
+}
+
+size_t EdgeChangeLog::after(uint64_t version) const {
+    size_t lower = 0;
+    size_t upper = count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if ((*this)[middle].version <= version) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower;
+}
+
+void EdgeChangeLog::push_back(const EdgeChange &change) {
+    if (count == blocks.size() * EDGE_CHANGE_BLOCK) blocks.push_back(make_shared<Block>());
+    blocks[count / EDGE_CHANGE_BLOCK]->changes[count % EDGE_CHANGE_BLOCK] = change;
+    count++;
+}
+
+uint64_t EdgeChangeLog::trim(size_t keep) {
+    size_t dropped = 0;
+    while (count - dropped * EDGE_CHANGE_BLOCK >= keep + EDGE_CHANGE_BLOCK) dropped++;
+    if (dropped == 0) return 0;
+    uint64_t version = blocks[dropped - 1]->changes[EDGE_CHANGE_BLOCK - 1].version;
+    blocks.erase(blocks.begin(), blocks.begin() + dropped);
+    count -= dropped * EDGE_CHANGE_BLOCK;
+    return version;
+}
@@ -0,0 +1,256 @@
+
+#include "GridModel.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define INCREMENTAL_LOGGER
+PrefixedLogger incrementalLogger = PrefixedLogger("[INCREMENT ]", true);
+
+// Arc changed since the version of a tree, weights are NEW_ARC for an arc missing in that version
+struct ArcChange {
+    uint32_t origin;
+    uint32_t target;
+    uint64_t oldWeight;
+    uint64_t newWeight;
+};
+
+thread_local SearchWorkspace treeWorkspace;
+
+// Class definition -------------------------------------------------------------------------------
+static uint64_t arcKey(uint32_t origin, uint32_t target) {
+    return (static_cast<uint64_t>(origin) << 32) | target;
+}
+
+static uint64_t arcWeight(const GridGraph &graph, uint32_t origin, uint32_t target) {
+    for (const GraphArc &arc: graph.arcsOf(origin)) {
+        if (arc.target == target) return arc.weight;
+    }
+    return NEW_ARC;
+}
+
+void PathTreeCache::rebuild(PathTree &tree, const GridGraph &graph, uint32_t originIndex) {
+    static thread_local SearchQueue pq;
+    pq.prepare(graph.size());
+    tree.distances.assign(graph.size(), UNREACHED);
+    tree.originIndex = originIndex;
+    tree.total = 0;
+
+    tree.distances[originIndex] = 0;
+    pq.push(0, originIndex);
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+        if (currentDistance > tree.distances[currentIndex]) continue;
+        tree.total += currentDistance;
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            uint64_t dist = currentDistance + weight;
+            if (dist >= tree.distances[neighborIndex]) continue;
+            tree.distances[neighborIndex] = dist;
+            pq.push(dist, neighborIndex);
+        }
+    }
+    tree.built = true;
+#ifdef INCREMENTAL_LOGGER
+    incrementalLogger.debug("Tree of %u rebuilt with total %lu", originIndex, tree.total);
+#endif
+}
+
+/**
+ * The update runs in two steps over the changes since the tree version. Increases are applied first,
+ * against the graph in which the decreased and added arcs still have their old weights. A cell is
+ * affected when no unaffected predecessor keeps it at its distance, candidates are decided in the
+ * order of their old distance so that all their predecessors on shortest paths are decided before.
+ * The affected cells are then searched again from their unaffected predecessors. Decreases and added
+ * arcs finally propagate shorter distances like a Dijkstra started from their targets. Both steps need
+ * positive weights, trees of graphs with zero arcs are rebuilt instead.
+ */
+bool PathTreeCache::update(PathTree &tree, const GridSnapshot &snapshot) {
+    const GridGraph &graph = snapshot.graph;
+    if (tree.version < snapshot.edgeChangesSince || graph.minWeight == 0) return false;
+
+    // Changes since the tree version, an arc changed several times keeps its oldest weight
+    const EdgeChangeLog &log = snapshot.edgeChanges;
+    size_t first = log.after(tree.version);
+    if (log.size() - first > INCREMENTAL_MAX_CHANGES) return false;
+
+    ankerl::unordered_dense::map<uint64_t, uint64_t> oldWeights;
+    vector<ArcChange> changes;
+    for (size_t position = first; position < log.size(); position++) {
+        const EdgeChange &change = log[position];
+        if (oldWeights.try_emplace(arcKey(change.origin, change.target), change.oldWeight).second) {
+            changes.push_back({change.origin, change.target, change.oldWeight, 0});
+        }
+    }
+    for (auto &change: changes) {
+        change.newWeight = arcWeight(graph, change.origin, change.target);
+        if (change.oldWeight == 0) return false;
+    }
+
+    // Weight of an arc before and after the increases, decreased and added arcs are not applied yet
+    auto weightBefore = [&oldWeights](uint32_t origin, uint32_t target, uint64_t weight) -> uint64_t {
+        auto found = oldWeights.find(arcKey(origin, target));
+        return found == oldWeights.end() ? weight : found->second;
+    };
+    auto weightBetween = [&oldWeights](uint32_t origin, uint32_t target, uint64_t weight) -> uint64_t {
+        auto found = oldWeights.find(arcKey(origin, target));
+        if (found == oldWeights.end()) return weight;
+        return found->second == NEW_ARC || weight < found->second ? found->second : weight;
+    };
+
+    uint32_t n = graph.size();
+    vector<uint64_t> &distances = tree.distances;
+    distances.resize(n, UNREACHED);
+    const uint32_t origin = tree.originIndex;
+
+    static thread_local SearchQueue pq;
+    SearchWorkspace &ws = treeWorkspace;
+    ankerl::unordered_dense::set<uint32_t> affected;
+
+    // Cells whose shortest path ended with an increased arc are the first candidates
+    pq.prepare(n);
+    ws.prepare(n);
+    for (const auto &change: changes) {
+        if (change.oldWeight == NEW_ARC || change.newWeight <= change.oldWeight) continue;
+        if (distances[change.origin] == UNREACHED || change.target == origin) continue;
+        if (distances[change.origin] + change.oldWeight == distances[change.target]) {
+            pq.push(distances[change.target], change.target);
+        }
+    }
+
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+        if (ws.settled(currentIndex)) continue;
+        ws.settle(currentIndex);
+
+        bool supported = false;
+        for (const auto &[predecessorIndex, weight]: graph.reverseArcsOf(currentIndex)) {
+            if (distances[predecessorIndex] == UNREACHED || affected.contains(predecessorIndex)) continue;
+            uint64_t between = weightBetween(predecessorIndex, currentIndex, weight);
+            if (between != NEW_ARC && distances[predecessorIndex] + between == currentDistance) {
+                supported = true;
+                break;
+            }
+        }
+        if (supported) continue;
+
+        affected.insert(currentIndex);
+        if (affected.size() > n / INCREMENTAL_MAX_AFFECTED) return false;
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            uint64_t before = weightBefore(currentIndex, neighborIndex, weight);
+            if (before == NEW_ARC || neighborIndex == origin || ws.settled(neighborIndex)) continue;
+            if (currentDistance + before == distances[neighborIndex]) {
+                pq.push(distances[neighborIndex], neighborIndex);
+            }
+        }
+    }
+
+    // Affected cells are searched again from their unaffected predecessors
+    for (uint32_t index: affected) {
+        tree.total -= distances[index];
+        distances[index] = UNREACHED;
+    }
+    pq.prepare(n);
+    for (uint32_t index: affected) {
+        uint64_t best = UNREACHED;
+        for (const auto &[predecessorIndex, weight]: graph.reverseArcsOf(index)) {
+            uint64_t between = weightBetween(predecessorIndex, index, weight);
+            if (distances[predecessorIndex] == UNREACHED || between == NEW_ARC) continue;
+            best = min(best, distances[predecessorIndex] + between);
+        }
+        if (best == UNREACHED) continue;
+        distances[index] = best;
+        pq.push(best, index);
+    }
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+        if (currentDistance > distances[currentIndex]) continue;
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            if (!affected.contains(neighborIndex)) continue;
+            uint64_t between = weightBetween(currentIndex, neighborIndex, weight);
+            if (between == NEW_ARC || currentDistance + between >= distances[neighborIndex]) continue;
+            distances[neighborIndex] = currentDistance + between;
+            pq.push(distances[neighborIndex], neighborIndex);
+        }
+    }
+    for (uint32_t index: affected) {
+        if (distances[index] != UNREACHED) tree.total += distances[index];
+    }
+
+    // Decreased and added arcs propagate shorter distances over the current graph
+    auto improve = [&tree, &distances](uint32_t index, uint64_t distance) {
+        if (distances[index] == UNREACHED) {
+            tree.total += distance;
+        } else {
+            tree.total -= distances[index] - distance;
+        }
+        distances[index] = distance;
+        pq.push(distance, index);
+    };
+
+    pq.prepare(n);
+    for (const auto &change: changes) {
+        if (change.oldWeight != NEW_ARC && change.newWeight >= change.oldWeight) continue;
+        if (distances[change.origin] == UNREACHED) continue;
+        uint64_t dist = distances[change.origin] + change.newWeight;
+        if (dist < distances[change.target]) improve(change.target, dist);
+    }
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+        if (currentDistance > distances[currentIndex]) continue;
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            uint64_t dist = currentDistance + weight;
+            if (dist < distances[neighborIndex]) improve(neighborIndex, dist);
+        }
+    }
+
+#ifdef INCREMENTAL_LOGGER
+    incrementalLogger.debug("Tree of %u updated over %lu changes, %lu cells affected", tree.originIndex,
+                            changes.size(), affected.size());
+#endif
+    return true;
+}
+
+uint64_t PathTreeCache::totalLength(const GridSnapshot &snapshot, uint64_t originCellId, uint32_t originIndex,
+                                   const function<uint64_t()> &search) {
+    if (originIndex == NO_CELL) return search();
+
+    shared_ptr<PathTree> tree;
+    {
+        lock_guard<mutex> lock(treesMutex);
+        auto found = find_if(trees.begin(), trees.end(), [originCellId](const shared_ptr<PathTree> &tree) {
+            return tree->originCellId == originCellId;
+        });
+        if (found != trees.end()) {
+            trees.splice(trees.begin(), trees, found);
+            tree = trees.front();
+        } else {
+            // A tree pays off only for an origin queried again, the first query just marks it
+            trees.push_front(make_shared<PathTree>(originCellId));
+            if (trees.size() > INCREMENTAL_TREES) trees.pop_back();
+        }
+    }
+    if (!tree) return search();
+
+    lock_guard<mutex> lock(tree->lock);
+    // A query pinned an older snapshot than the one the tree was already moved to
+    if (tree->built && tree->version > snapshot.version) return search();
+
+    if (!tree->built || tree->originIndex != originIndex) {
+        rebuild(*tree, snapshot.graph, originIndex);
+    } else if (tree->version != snapshot.version && !update(*tree, snapshot)) {
+        rebuild(*tree, snapshot.graph, originIndex);
+    }
+    tree->version = snapshot.version;
+    return tree->total;
+}
+
+void PathTreeCache::clear() {
+    lock_guard<mutex> lock(treesMutex);
+    trees.clear();
+}
@@ -0,0 +1,51 @@
+#include "GridIngest.hh"
+#include "Logger.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define INGEST_LOGGER
+PrefixedLogger ingestLogger = PrefixedLogger("[INGEST    ]", true);
+
+// Class definition -------------------------------------------------------------------------------
+IngestQueue::Node *IngestQueue::popNode() {
+    Node *current = tail;
+    Node *next = current->next.load(memory_order_acquire);
+    if (current == &stub) {
+        if (!next) return nullptr;
+        tail = current = next;
+        next = next->next.load(memory_order_acquire);
+    }
+    if (next) {
+        tail = next;
+        return current;
+    }
+
+    // A producer is between its exchange and its link, its node is popped on a later call
+    if (current != head.load(memory_order_acquire)) return nullptr;
+
+    // The last node leaves only with the stub behind it
+    pushNode(&stub);
+    next = current->next.load(memory_order_acquire);
+    if (next) {
+        tail = next;
+        return current;
+    }
+    return nullptr;
+}
+
+void IngestQueue::popBatch(vector<IngestRequest> &batch, size_t max, bool wait) {
+    while (true) {
+        // Pushes after this load change the counter, so a push missed below wakes the wait
+        uint64_t seen = pushed.load(memory_order_acquire);
+        while (batch.size() < max) {
+            Node *node = popNode();
+            if (!node) break;
+            batch.push_back(std::move(node->item));
+            delete node;
+        }
+        if (!batch.empty() || !wait) break;
+        pushed.wait(seen, memory_order_acquire);
+    }
+#ifdef INGEST_LOGGER
+    ingestLogger.debug("Writer took a batch of %lu requests", batch.size());
+#endif
+}
@@ -0,0 +1,69 @@
+#ifndef GRID_INGEST_HH
+#define GRID_INGEST_HH
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "scheme.pb.h"
+
+// Global variables -------------------------------------------------------------------------------
+// Requests the writer applies under one acquisition of the grid lock at most
+#ifndef INGEST_MAX_BATCH
+#define INGEST_MAX_BATCH 256
+#endif
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+// Parsed walk or reset waiting for the writer, done answers the client once it is applied
+struct IngestRequest {
+    esw::Request request;
+    function<void()> done;
+};
+
+/**
+ * Lock-free multi-producer single-consumer queue of the requests changing the grid, after Vyukov's
+ * intrusive list. Producers only exchange the head, so I/O threads never wait for each other or for
+ * the writer. The writer sleeps on the push counter while the queue is empty.
+ */
+class IngestQueue {
+private:
+    struct Node {
+        atomic<Node *> next;
+        IngestRequest item;
+    };
+
+    atomic<Node *> head;        // last pushed node
+    Node *tail;                 // next node to pop, touched by the writer only
+    Node stub;
+    atomic<uint64_t> pushed;
+
+    void pushNode(Node *node) {
+        node->next.store(nullptr, memory_order_relaxed);
+        Node *previous = head.exchange(node, memory_order_acq_rel);
+        previous->next.store(node, memory_order_release);
+    }
+
+    Node *popNode();
+public:
+    IngestQueue() : head(&stub), tail(&stub), pushed(0) {
+        stub.next.store(nullptr, memory_order_relaxed);
+    }
+
+    ~IngestQueue() {
+        while (Node *node = popNode()) delete node;
+    }
+
+    void push(IngestRequest item) {
+        pushNode(new Node{{nullptr}, std::move(item)});
+        pushed.fetch_add(1, memory_order_release);
+        pushed.notify_one();
+    }
+
+    // Moves requests to the batch until it holds max, waits while there are none unless told otherwise
+    void popBatch(vector<IngestRequest> &batch, size_t max, bool wait = true);
+};
+
+#endif //GRID_INGEST_HH
@@ -0,0 +1,186 @@
+#include "GridModel.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define LANDMARK_LOGGER
+PrefixedLogger landmarkLogger = PrefixedLogger("[LANDMARK  ]", true);
+
+// Class definition -------------------------------------------------------------------------------
+// Distances from the origin over the given adjacency, LANDMARK_UNREACHED for cells not reached
+static void distancesFrom(const vector<uint32_t> &offsets, const vector<GraphArc> &arcs, uint32_t originIndex,
+                          vector<uint64_t> &distances) {
+    static thread_local SearchQueue pq;
+    pq.prepare(distances.size());
+    fill(distances.begin(), distances.end(), LANDMARK_UNREACHED);
+
+    distances[originIndex] = 0;
+    pq.push(0, originIndex);
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+        if (currentDistance > distances[currentIndex]) continue;
+
+        for (uint32_t arc = offsets[currentIndex]; arc < offsets[currentIndex + 1]; arc++) {
+            const auto &[neighborIndex, weight] = arcs[arc];
+            uint64_t dist = currentDistance + weight;
+            if (dist >= distances[neighborIndex]) continue;
+            distances[neighborIndex] = dist;
+            pq.push(dist, neighborIndex);
+        }
+    }
+}
+
+void LandmarkIndex::build(const GridGraph &graph) {
+    version = graph.version;
+    size = graph.size();
+    count = min<uint32_t>(LANDMARK_COUNT, size);
+    landmarks.clear();
+    forward.assign(static_cast<size_t>(size) * count, LANDMARK_UNREACHED);
+    backward.assign(static_cast<size_t>(size) * count, LANDMARK_UNREACHED);
+    if (count == 0) return;
+
+    // The best connected cell lies in the main component, the first landmark is the cell farthest from it
+    uint32_t center = 0;
+    for (uint32_t index = 1; index < size; index++) {
+        if (graph.offsets[index + 1] - graph.offsets[index] > graph.offsets[center + 1] - graph.offsets[center]) {
+            center = index;
+        }
+    }
+    vector<uint64_t> distances(size);
+    vector<uint64_t> nearest(size, LANDMARK_UNREACHED);
+    distancesFrom(graph.offsets, graph.arcs, center, distances);
+    for (uint32_t index = 0; index < size; index++) {
+        if (distances[index] == LANDMARK_UNREACHED) nearest[index] = 0;
+    }
+
+    // Every next landmark is the cell farthest from the chosen ones, cells they do not reach are never chosen
+    uint32_t next = center;
+    for (uint32_t index = 0; index < size; index++) {
+        if (nearest[index] != 0 && distances[index] > distances[next]) next = index;
+    }
+    for (uint32_t landmark = 0; landmark < count; landmark++) {
+        landmarks.push_back(next);
+        distancesFrom(graph.offsets, graph.arcs, next, distances);
+        for (uint32_t index = 0; index < size; index++) {
+            forward[static_cast<size_t>(index) * count + landmark] = distances[index];
+            if (distances[index] < nearest[index]) nearest[index] = distances[index];
+        }
+        distancesFrom(graph.reverseOffsets, graph.reverseArcs, next, distances);
+        for (uint32_t index = 0; index < size; index++) {
+            backward[static_cast<size_t>(index) * count + landmark] = distances[index];
+        }
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+    }
+#ifdef LANDMARK_LOGGER
+    landmarkLogger.debug("Built %u landmarks over %u cells at version %lu", count, size, version);
+#endif
+}
+
+bool LandmarkIndex::covers(const GridSnapshot &snapshot) const {
+    return version <= snapshot.version && snapshot.edgeChangesSince <= version;
+}
+
+LandmarkBounds::LandmarkBounds(const shared_ptr<const LandmarkIndex> &index, const LandmarkBounds *previous,
+                               const GridSnapshot &snapshot) : index(index), version(snapshot.version) {
+    uint64_t since = index->version;
+    if (previous) {
+        forwardRepairs = previous->forwardRepairs;
+        backwardRepairs = previous->backwardRepairs;
+        since = previous->version;
+    }
+    auto first = partition_point(snapshot.edgeChanges.begin(), snapshot.edgeChanges.end(),
+                                 [&](const EdgeChange &change) { return change.version <= since; });
+    const EdgeChange *begin = snapshot.edgeChanges.data() + (first - snapshot.edgeChanges.begin());
+    const EdgeChange *end = snapshot.edgeChanges.data() + snapshot.edgeChanges.size();
+    repair(snapshot.graph, begin, end, false);
+    repair(snapshot.graph, begin, end, true);
+#ifdef LANDMARK_LOGGER
+    landmarkLogger.debug("Repaired %lu distances over %ld changes for version %lu", repairs(), end - begin,
+                         snapshot.version);
+#endif
+}
+
+/**
+ * Moves the distances of one direction until every arc of the graph satisfies the triangle inequality,
+ * d(head) <= d(tail) + weight. Arcs unchanged since the index satisfy it already, so only the changed ones
+ * seed the repair. A head the landmark did not reach is lowered and its new descendants with it, any other
+ * violated arc raises its tail instead. Raising moves only the cells on the shortest paths into the tail,
+ * while lowering a shortened arc would move its whole subtree. Lengthened arcs need no repair at all.
+ */
+void LandmarkBounds::repair(const GridGraph &graph, const EdgeChange *first, const EdgeChange *last, bool reverse) {
+    const vector<uint32_t> &offsets = reverse ? graph.reverseOffsets : graph.offsets;
+    const vector<GraphArc> &arcs = reverse ? graph.reverseArcs : graph.arcs;
+    const vector<uint32_t> &inOffsets = reverse ? graph.offsets : graph.reverseOffsets;
+    const vector<GraphArc> &inArcs = reverse ? graph.arcs : graph.reverseArcs;
+    auto &repairs = reverse ? backwardRepairs : forwardRepairs;
+    uint32_t count = index->count;
+    BinaryHeapQueue pq;
+
+    for (uint32_t landmark = 0; landmark < count; landmark++) {
+        auto distance = [&](uint32_t cell) {
+            return reverse ? backward(cell, landmark) : forward(cell, landmark);
+        };
+        auto weight = [&](uint32_t tail, uint32_t head) {
+            for (uint32_t arc = offsets[tail]; arc < offsets[tail + 1]; arc++) {
+                if (arcs[arc].target == head) return static_cast<uint64_t>(arcs[arc].weight);
+            }
+            return LANDMARK_UNREACHED;
+        };
+
+        // Cells newly reached from the landmark are lowered in the order of their distances
+        pq.prepare(graph.size());
+        for (const EdgeChange *change = first; change != last; change++) {
+            uint32_t tail = reverse ? change->target : change->origin;
+            uint32_t head = reverse ? change->origin : change->target;
+            uint64_t dist = distance(tail) + weight(tail, head);
+            if (distance(head) == LANDMARK_UNREACHED && dist < LANDMARK_UNREACHED) pq.push(dist, head);
+        }
+        while (!pq.empty()) {
+            auto [currentDistance, currentIndex] = pq.top();
+            pq.pop();
+            if (currentDistance >= distance(currentIndex)) continue;
+            repairs[static_cast<uint64_t>(currentIndex) * count + landmark] = currentDistance;
+
+            for (uint32_t arc = offsets[currentIndex]; arc < offsets[currentIndex + 1]; arc++) {
+                const auto &[neighborIndex, weight] = arcs[arc];
+                uint64_t dist = currentDistance + weight;
+                if (dist < distance(neighborIndex)) pq.push(dist, neighborIndex);
+            }
+        }
+
+        // Tails of the arcs still violated are raised, highest first, keyed downwards by the complement
+        pq.prepare(graph.size());
+        for (const EdgeChange *change = first; change != last; change++) {
+            uint32_t tail = reverse ? change->target : change->origin;
+            uint32_t head = reverse ? change->origin : change->target;
+            uint64_t length = weight(tail, head);
+            if (distance(tail) + length < distance(head)) pq.push(LANDMARK_UNREACHED - (distance(head) - length), tail);
+        }
+        while (!pq.empty()) {
+            auto [key, currentIndex] = pq.top();
+            pq.pop();
+            uint64_t currentDistance = LANDMARK_UNREACHED - key;
+            if (currentDistance <= distance(currentIndex)) continue;
+            repairs[static_cast<uint64_t>(currentIndex) * count + landmark] = currentDistance;
+
+            for (uint32_t arc = inOffsets[currentIndex]; arc < inOffsets[currentIndex + 1]; arc++) {
+                const auto &[neighborIndex, weight] = inArcs[arc];
+                if (currentDistance > weight && currentDistance - weight > distance(neighborIndex)) {
+                    pq.push(LANDMARK_UNREACHED - (currentDistance - weight), neighborIndex);
+                }
+            }
+        }
+    }
+}
+
+shared_ptr<const LandmarkBounds> GridData::getLandmarkBounds(const shared_ptr<const LandmarkIndex> &index,
+                                                             const GridSnapshot &snapshot) {
+    lock_guard<mutex> lock(landmarkBoundsMutex);
+    bool current = landmarkBounds && landmarkBounds->index == index;
+    if (current && landmarkBounds->version == snapshot.version) return landmarkBounds;
+
+    // Only the latest bounds advance, a query on an older snapshot repairs its own from the index
+    bool newer = current && landmarkBounds->version < snapshot.version;
+    auto bounds = make_shared<const LandmarkBounds>(index, newer ? landmarkBounds.get() : nullptr, snapshot);
+    if (!current || newer) landmarkBounds = bounds;
+    return bounds;
+}
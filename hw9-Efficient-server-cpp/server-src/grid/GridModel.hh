@@ -16,11 +16,23 @@
 #include <future>
 #include <utility>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <functional>
+#include <array>
+#include <span>
 
 #include "scheme.pb.h"
 #include "robin_map.h"
 #include "unordered_dense.h"
 
+#include "GridQueue.hh"
+#include "GridCache.hh"
+#include "GridIngest.hh"
+#include "SmallVector.hh"
+
 #include "Logger.hh"
 
 // Global variables -------------------------------------------------------------------------------
@@ -29,7 +41,60 @@
 
 #define CHUNKS 100
 
+#define NO_CELL     numeric_limits<uint32_t>::max()
+#define UNREACHED   numeric_limits<uint64_t>::max()
+#define NEW_ARC     numeric_limits<uint64_t>::max()
+
+// Relative slack keeping the geometric heuristic consistent despite floating point rounding
+#define HEURISTIC_MARGIN 0.999
+
+// Side of the square tiles of the cell index in bits of the cell coordinates
+#define CELL_TILE_BITS 2
+#define CELL_TILE_SIZE (1u << CELL_TILE_BITS)
+
+#if defined(ENABLE_CONCURRENT_INGESTION) && defined(ENABLE_CELL_TILE_INDEX)
+#error "The tiled cell index does not support concurrent ingestion"
+#endif
+#if defined(ENABLE_CONCURRENT_INGESTION) && defined(ENABLE_BATCHED_INGESTION)
+#error "Batched ingestion has a single writer, it excludes concurrent ingestion"
+#endif
+
+// Edges a cell keeps inline per direction before moving them to the heap
+#define CELL_INLINE_EDGES 2
+// Edges of one direction a cell scans before they are indexed by the arc
+#define EDGE_INDEX_DEGREE 8
+// Arcs changed between two published snapshots beyond which the next graph is built from scratch
+#define PUBLISH_MAX_CHANGES 65536
+// Cells per block of the snapshot graph in bits, a snapshot shares the blocks no change touched
+#define GRAPH_BLOCK_BITS 8
+#define GRAPH_BLOCK_SIZE (1u << GRAPH_BLOCK_BITS)
+// Chunks of the cell index of a snapshot in bits, a snapshot shares the chunks no new cell fell into
+#define SNAPSHOT_INDEX_BITS 10
+// Edge changes per block of the log, a snapshot shares the blocks and reads only the changes published with it
+#define EDGE_CHANGE_BLOCK 1024
+
+// Shortest path trees kept for repeated OneToAll origins, and the edge changes a tree is updated over
+#ifndef INCREMENTAL_TREES
+#define INCREMENTAL_TREES 4
+#endif
+#ifndef INCREMENTAL_MAX_CHANGES
+#define INCREMENTAL_MAX_CHANGES 4096
+#endif
+// An update invalidating more than one in this many cells is recomputed instead
+#define INCREMENTAL_MAX_AFFECTED 8
+
+// Landmarks of the ALT heuristic, and the edge changes after which their index is rebuilt
+#ifndef LANDMARK_COUNT
+#define LANDMARK_COUNT 8
+#endif
+#ifndef LANDMARK_REBUILD_CHANGES
+#define LANDMARK_REBUILD_CHANGES 2048
+#endif
+// Landmark distance of a cell it does not reach, arc weights still add to it without overflow
+#define LANDMARK_UNREACHED (uint64_t(1) << 62)
+
 extern std::shared_mutex rwLock;
+extern IngestQueue ingestQueue;
 
 // Class definition -------------------------------------------------------------------------------
 using namespace std;
@@ -38,7 +103,7 @@ using namespace std;
 class GridStats {
 private:
 public:
-    uint64_t edges_count;
+    atomic<uint64_t> edges_count;
     pair <uint64_t, uint64_t> highestCoordX;
     pair <uint64_t, uint64_t> highestCoordY;
     pair <uint64_t, uint64_t> lowestCoordX;
@@ -46,10 +111,11 @@ public:
 
     vector<uint64_t> quad;
 
-    uint64_t walk_count;
-    uint64_t oneToOne_count;
-    uint64_t oneToAll_count;
-    uint64_t location_count;
+    atomic<uint64_t> walk_count;
+    atomic<uint64_t> oneToOne_count;
+    atomic<uint64_t> oneToAll_count;
+    atomic<uint64_t> manyToMany_count;
+    atomic<uint64_t> location_count;
 
     GridStats() {
         edges_count = 0;
@@ -65,6 +131,7 @@ public:
         walk_count = 0;
         oneToOne_count = 0;
         oneToAll_count = 0;
+        manyToMany_count = 0;
         location_count = 0;
     }
 
@@ -76,28 +143,647 @@ struct Point {
     uint64_t y;
 };
 
+// Edge to or from a neighbouring cell by its dense index, the length sums all samples
 struct Edge {
-    uint64_t id;
+    uint32_t index;
+    uint32_t samples;
     uint64_t length;
-    uint64_t samples;
 };
 
+using EdgeList = SmallVector<Edge, CELL_INLINE_EDGES>;
+
+// The id and the coordinates follow from the key and the point, points come from int32 locations
 struct Cell {
-    uint64_t id;
-    uint64_t coordX;
-    uint64_t coordY;
-    uint64_t pointX;
-    uint64_t pointY;
-    vector<Edge> edges;
-    vector<Edge> inEdges;
+    uint32_t index;
+    int32_t pointX;
+    int32_t pointY;
+    EdgeList edges;
+    EdgeList inEdges;
+
+    // Representative point widened like the locations it came from
+    Point point() const {
+        return {static_cast<uint64_t>(static_cast<int64_t>(pointX)), static_cast<uint64_t>(static_cast<int64_t>(pointY))};
+    }
+};
+
+/**
+ * Positions of the edges of high-degree cells in one direction. Lists of at most EDGE_INDEX_DEGREE
+ * edges are scanned, a list growing beyond that is indexed by the arc from then on.
+ */
+class EdgeIndex {
+private:
+    ankerl::unordered_dense::map<uint64_t, uint32_t> positions;     // arc -> position in the list
+
+    static uint64_t arcKey(uint32_t cellIndex, uint32_t neighbourIndex) {
+        return (static_cast<uint64_t>(cellIndex) << 32) | neighbourIndex;
+    }
+public:
+    // Edge of the cell to or from the neighbour, nullptr when missing
+    Edge *find(EdgeList &edges, uint32_t cellIndex, uint32_t neighbourIndex) const {
+        if (edges.size() <= EDGE_INDEX_DEGREE) {
+            for (auto &edge: edges) {
+                if (edge.index == neighbourIndex) return &edge;
+            }
+            return nullptr;
+        }
+        auto found = positions.find(arcKey(cellIndex, neighbourIndex));
+        return found == positions.end() ? nullptr : edges.begin() + found->second;
+    }
+
+    void append(EdgeList &edges, uint32_t cellIndex, const Edge &edge);
+
+    void clear() {
+        positions.clear();
+    }
+
+    size_t memoryUsage() const {
+        return positions.values().capacity() * sizeof(pair<uint64_t, uint32_t>) +
+               positions.bucket_count() * sizeof(ankerl::unordered_dense::bucket_type::standard);
+    }
+};
+
+// Bytes held by the grid and its snapshots, capacities rather than sizes
+struct GridMemory {
+    size_t cellCount;
+    size_t cells;           // cell maps with their buckets
+    size_t edgeCount;
+    size_t spilledEdges;    // edge lists of cells beyond the inline capacity
+    size_t spilledCells;
+    size_t cellIds;
+    size_t cellIndex;
+    size_t edgeIndex;
+    size_t edgeChanges;
+    size_t graph;
+    size_t chainGraph;
+
+    size_t total() const {
+        return cells + spilledEdges + cellIds + cellIndex + edgeIndex + edgeChanges + graph + chainGraph;
+    }
+};
+
+/**
+ * Locks of the cell chunks for walks applied concurrently. A writer collects the chunks of all cells
+ * one step of a walk may touch and takes their locks in ascending order, so writers of overlapping
+ * neighbourhoods cannot deadlock while walks of disjoint chunks proceed in parallel.
+ */
+class ChunkLocks {
+private:
+    array<mutex, CHUNKS> locks;
+
+    static_assert(CHUNKS <= 128, "Chunks of a lock set have to fit its two words");
+public:
+    struct Set {
+        uint64_t words[2] = {0, 0};
+
+        void add(uint64_t cellId) {
+            uint32_t chunk = cellId % CHUNKS;
+            words[chunk >> 6] |= 1ull << (chunk & 63);
+        }
+    };
+
+    void lock(const Set &set) {
+        for (uint32_t word = 0; word < 2; word++) {
+            for (uint64_t bits = set.words[word]; bits; bits &= bits - 1) {
+                locks[word * 64 + __builtin_ctzll(bits)].lock();
+            }
+        }
+    }
+
+    void unlock(const Set &set) {
+        for (uint32_t word = 0; word < 2; word++) {
+            for (uint64_t bits = set.words[word]; bits; bits &= bits - 1) {
+                locks[word * 64 + __builtin_ctzll(bits)].unlock();
+            }
+        }
+    }
+};
+
+class GridData;
+class ThreadPool;
+
+// Offsets of the neighbouring cells in the order a location probes them
+extern const std::vector<std::pair<int64_t, int64_t>> precomputedNeighbourPairs;
+
+/**
+ * Direct-addressed index from cell ids to cell indices. The halves of a cell id address a 2D plane of
+ * square tiles allocated on demand, neighbouring cells are mostly slots of the same tile. Only the
+ * occupancy of the tiles is hashed, so probing an empty neighbour does not touch the tiles at all. The
+ * halves are used as they are, so ids built from sign-extended coordinates resolve like in the maps.
+ */
+class CellTileIndex {
+private:
+    struct Slot {
+        uint32_t index;
+        Point point;        // representative point of the cell
+    };
+
+    struct Tile {
+        Slot slots[CELL_TILE_SIZE * CELL_TILE_SIZE];
+    };
+
+    struct TileEntry {
+        uint32_t position;  // tile in tiles
+        uint32_t occupied;  // bit per slot holding a cell
+    };
+
+    static_assert(CELL_TILE_SIZE * CELL_TILE_SIZE <= 32, "Occupancy of a tile has to fit its mask");
+
+    ankerl::unordered_dense::map<uint64_t, TileEntry> entries;
+    vector<Tile> tiles;
+
+    static uint64_t tileKey(uint64_t cellId) {
+        return ((cellId >> 32 >> CELL_TILE_BITS) << 32) | (static_cast<uint32_t>(cellId) >> CELL_TILE_BITS);
+    }
+
+    static uint32_t slotOf(uint64_t cellId) {
+        return ((cellId >> 32) & (CELL_TILE_SIZE - 1)) << CELL_TILE_BITS | (cellId & (CELL_TILE_SIZE - 1));
+    }
+public:
+    // Last tile looked up, consecutive probes of one neighbourhood mostly skip the tile lookup
+    struct Cursor {
+        uint64_t key = numeric_limits<uint64_t>::max();
+        TileEntry entry = {0, 0};
+    };
+
+    uint32_t find(uint64_t cellId, Cursor &cursor) const {
+        uint64_t key = tileKey(cellId);
+        if (key != cursor.key) {
+            auto found = entries.find(key);
+            cursor.key = key;
+            cursor.entry = found == entries.end() ? TileEntry{0, 0} : found->second;
+        }
+        uint32_t slot = slotOf(cellId);
+        if (!(cursor.entry.occupied >> slot & 1)) return NO_CELL;
+        return tiles[cursor.entry.position].slots[slot].index;
+    }
+
+    uint32_t find(uint64_t cellId) const {
+        Cursor cursor;
+        return find(cellId, cursor);
+    }
+
+    // Representative point of a cell the cursor has just found
+    const Point &point(uint64_t cellId, const Cursor &cursor) const {
+        return tiles[cursor.entry.position].slots[slotOf(cellId)].point;
+    }
+
+    void insert(uint64_t cellId, uint32_t index, const Point &point);
+
+    void clear() {
+        entries.clear();
+        tiles.clear();
+    }
+
+    size_t memoryUsage() const {
+        return entries.values().capacity() * sizeof(pair<uint64_t, TileEntry>) +
+               entries.bucket_count() * sizeof(ankerl::unordered_dense::bucket_type::standard) +
+               tiles.capacity() * sizeof(Tile);
+    }
+};
+
+// Packed adjacency entry of the CSR graph
+struct GraphArc {
+    uint32_t target;
+    uint32_t weight;
+};
+
+// Arc added or reweighted since the last published snapshot
+struct ChangedArc {
+    uint32_t tail;
+    uint32_t head;
+};
+
+// Representative point of a cell in millimetres
+struct GraphPoint {
+    double x;
+    double y;
+};
+
+// Arcs of one direction of a block of consecutive cells in CSR layout, the offsets are local to the block
+struct ArcBlock {
+    vector<GraphArc> arcs;
+    uint32_t offsets[GRAPH_BLOCK_SIZE + 1];     // cell of the block -> first arc, unused cells have none
+};
+
+// Representative points of a block of consecutive cells
+struct PointBlock {
+    GraphPoint points[GRAPH_BLOCK_SIZE];
+};
+
+/**
+ * Read-only compressed-sparse-row snapshot of the grid graph, searched by all queries. The cells are laid
+ * out in blocks held by shared pointers, a graph built from the previous one shares every block none of
+ * the changed or appended cells falls into.
+ */
+class GridGraph {
+private:
+    uint32_t cells;
+    size_t arcTotal;
+    vector<shared_ptr<const ArcBlock>> arcBlocks;           // block -> targets with averaged lengths
+    vector<shared_ptr<const ArcBlock>> reverseArcBlocks;    // block -> sources with averaged lengths
+    vector<shared_ptr<const PointBlock>> pointBlocks;       // block -> representative points
+public:
+    uint64_t version;
+    double heuristicScale;              // lowest arc length per millimetre of point distance
+    uint32_t minWeight;                 // lowest arc weight
+
+    GridGraph() : cells(0), arcTotal(0), version(0), heuristicScale(1.0), minWeight(0) {}
+
+    uint32_t size() const {
+        return cells;
+    }
+
+    size_t arcCount() const {
+        return arcTotal;
+    }
+
+    span<const GraphArc> arcsOf(uint32_t index) const {
+        const ArcBlock &block = *arcBlocks[index >> GRAPH_BLOCK_BITS];
+        uint32_t cell = index & (GRAPH_BLOCK_SIZE - 1);
+        return {block.arcs.data() + block.offsets[cell], block.offsets[cell + 1] - block.offsets[cell]};
+    }
+
+    span<const GraphArc> reverseArcsOf(uint32_t index) const {
+        const ArcBlock &block = *reverseArcBlocks[index >> GRAPH_BLOCK_BITS];
+        uint32_t cell = index & (GRAPH_BLOCK_SIZE - 1);
+        return {block.arcs.data() + block.offsets[cell], block.offsets[cell + 1] - block.offsets[cell]};
+    }
+
+    const GraphPoint &point(uint32_t index) const {
+        return pointBlocks[index >> GRAPH_BLOCK_BITS]->points[index & (GRAPH_BLOCK_SIZE - 1)];
+    }
+
+    void build(GridData &gridData);
+
+    // Builds the graph from the previous one, sharing the blocks of the cells no change touched and reading only
+    // the changed and appended cells from the grid. The bounds only move down, so the heuristic stays admissible
+    void update(const GridGraph &previous, GridData &gridData, const vector<ChangedArc> &changes);
+
+    // Bytes of the blocks, including those shared with other graphs
+    size_t memoryUsage() const;
+
+    // Lower bound on the remaining path length from a cell to the destination point
+    uint64_t heuristic(uint32_t index, const GraphPoint &destination) const {
+        const GraphPoint &origin = point(index);
+        double dx = origin.x - destination.x;
+        double dy = origin.y - destination.y;
+        return static_cast<uint64_t>(heuristicScale * sqrt(dx * dx + dy * dy));
+    }
+};
+
+/**
+ * Cell ids of a snapshot by chunks of their hash. Appended cells fall into few chunks each, the
+ * snapshot built next copies only those and shares the others with the previous one.
+ */
+class SnapshotCellIndex {
+private:
+    using Chunk = ankerl::unordered_dense::map<uint64_t, uint32_t>;
+
+    vector<shared_ptr<Chunk>> chunks;
+    size_t count;
+
+    static uint32_t chunkOf(uint64_t cellId) {
+        return ankerl::unordered_dense::hash<uint64_t>{}(cellId) >> (64 - SNAPSHOT_INDEX_BITS);
+    }
+public:
+    SnapshotCellIndex() : count(0) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    uint32_t find(uint64_t cellId) const {
+        if (chunks.empty()) return NO_CELL;
+        const Chunk &chunk = *chunks[chunkOf(cellId)];
+        auto found = chunk.find(cellId);
+        return found == chunk.end() ? NO_CELL : found->second;
+    }
+
+    // Adds the cells from the first index on, a chunk is copied on its first new cell
+    void append(const vector<uint64_t> &cellIds, uint32_t first);
+
+    size_t memoryUsage() const;
+};
+
+// Entry of a OneToAll search into the junction graph
+struct ChainOrigin {
+    uint32_t junction;      // first junction to settle, NO_CELL when the search ends on the origin chain
+    uint64_t distance;      // distance of that junction from the origin
+    uint32_t head;          // head junction of the origin chain, NO_CELL for a junction origin
+    uint64_t tailCount;     // members of the origin chain from the origin on
+    uint64_t tailOffsets;   // summed offsets of those members from the chain head
+    uint64_t sum;           // distances summed along the origin chain already
+};
+
+// Arc of the chain graph, either a plain arc or a shortcut over a chain of interior cells
+struct ChainArc {
+    uint32_t target;
+    uint64_t weight;
+};
+
+/**
+ * Read-only graph of the junction cells for OneToAll. A cell with exactly one in-edge and one out-edge
+ * is interior, maximal chains of interior cells are replaced by shortcut arcs between junctions. The
+ * distance of an interior cell is the distance of its chain head plus its offset in the chain.
+ */
+class ChainGraph {
+private:
+public:
+    uint64_t version;
+    vector<uint32_t> offsets;               // cell index -> first arc, interior cells have none
+    vector<ChainArc> arcs;                  // plain arcs and chain shortcuts
+    vector<uint64_t> interiorCounts;        // junction -> interior cells of its chains
+    vector<uint64_t> interiorOffsets;       // junction -> summed offsets of those interior cells
+    vector<uint32_t> chainOf;               // cell index -> chain, NO_CELL for junctions
+    vector<uint32_t> memberOf;              // cell index -> position in members
+    vector<uint32_t> chainStarts;           // chain -> first member, chains + 1 entries
+    vector<uint32_t> chainHeads;            // chain -> head junction, NO_CELL for cycles
+    vector<uint32_t> members;               // interior cells ordered along their chains
+    vector<uint64_t> memberOffsets;         // member -> distance from the chain head
+    uint64_t meanWeight;                    // mean arc weight, at least one
+
+    ChainGraph() : version(0), meanWeight(1) {
+        offsets.push_back(0);
+        chainStarts.push_back(0);
+    }
+
+    uint32_t size() const {
+        return offsets.size() - 1;
+    }
+
+    bool isInterior(uint32_t index) const {
+        return chainOf[index] != NO_CELL;
+    }
+
+    void build(const GridGraph &graph);
+
+    ChainOrigin locate(const GridGraph &graph, uint32_t originIndex) const;
+
+    // Distance sum of a settled junction and the interior cells of its chains
+    uint64_t settledSum(uint32_t index, uint64_t distance, const ChainOrigin &origin) const {
+        uint64_t sum = distance + interiorCounts[index] * distance + interiorOffsets[index];
+        // The origin chain was summed from the origin on, not from its head
+        if (index == origin.head) {
+            sum -= origin.tailCount * distance + origin.tailOffsets;
+        }
+        return sum;
+    }
+};
+
+// Per-thread reusable search state, an entry is valid only when stamped by the current search
+class SearchWorkspace {
+private:
+    uint32_t epoch;
+    vector<uint32_t> stamps;
+public:
+    vector<uint64_t> distances;
+
+    SearchWorkspace() : epoch(0) {}
+
+    void prepare(uint32_t size);
+
+    bool reached(uint32_t node) const {
+        return stamps[node] == epoch;
+    }
+
+    bool settled(uint32_t node) const {
+        return stamps[node] == epoch + 1;
+    }
+
+    void reach(uint32_t node, uint64_t distance) {
+        stamps[node] = epoch;
+        distances[node] = distance;
+    }
+
+    void settle(uint32_t node) {
+        stamps[node] = epoch + 1;
+    }
+};
+
+// Change of an averaged edge length, kept for updating the shortest path trees
+struct EdgeChange {
+    uint64_t version;       // grid version after the change
+    uint32_t origin;
+    uint32_t target;
+    uint64_t oldWeight;     // NEW_ARC for an added edge
+};
+
+class GridSnapshot;
+
+/**
+ * ALT landmark distances of one snapshot, built in the background. Landmarks are picked farthest first,
+ * each keeps the distances from it over the arcs and to it over the reverse arcs. By the triangle
+ * inequality d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L) for every landmark L.
+ */
+class LandmarkIndex {
+private:
+public:
+    uint64_t version;
+    uint32_t size;                  // cells of the graph it was built on
+    uint32_t count;                 // landmarks, fewer than LANDMARK_COUNT on tiny graphs
+    vector<uint32_t> landmarks;
+    vector<uint64_t> forward;       // cell * count + landmark -> distance from the landmark
+    vector<uint64_t> backward;      // cell * count + landmark -> distance to the landmark
+
+    LandmarkIndex() : version(0), size(0), count(0) {}
+
+    void build(const GridGraph &graph);
+
+    // The snapshot logs all edge changes since the index, so its bounds can be repaired
+    bool covers(const GridSnapshot &snapshot) const;
+};
+
+/**
+ * Landmark distances of an index made feasible on a later snapshot. An arc that got shorter or was added
+ * since the index may break the triangle inequality, the distances are moved from it on until no arc does.
+ * The bounds then stay admissible and consistent and only prune less than on a fresh index. Moved
+ * distances are kept sparsely beside the shared index, the bounds of a version start from those of the
+ * previous one and repair only the changes since.
+ */
+class LandmarkBounds {
+private:
+    ankerl::unordered_dense::map<uint64_t, uint64_t> forwardRepairs;    // cell * count + landmark -> distance
+    ankerl::unordered_dense::map<uint64_t, uint64_t> backwardRepairs;
+
+    void repair(const GridGraph &graph, const EdgeChange *first, const EdgeChange *last, bool reverse);
+public:
+    shared_ptr<const LandmarkIndex> index;
+    uint64_t version;
+
+    // Repairs the index for the snapshot, starting from the bounds of an earlier version of it if given
+    LandmarkBounds(const shared_ptr<const LandmarkIndex> &index, const LandmarkBounds *previous,
+                   const GridSnapshot &snapshot);
+
+    uint64_t forward(uint32_t cell, uint32_t landmark) const {
+        uint64_t key = static_cast<uint64_t>(cell) * index->count + landmark;
+        if (!forwardRepairs.empty()) {
+            auto repaired = forwardRepairs.find(key);
+            if (repaired != forwardRepairs.end()) return repaired->second;
+        }
+        return cell < index->size ? index->forward[key] : LANDMARK_UNREACHED;
+    }
+
+    uint64_t backward(uint32_t cell, uint32_t landmark) const {
+        uint64_t key = static_cast<uint64_t>(cell) * index->count + landmark;
+        if (!backwardRepairs.empty()) {
+            auto repaired = backwardRepairs.find(key);
+            if (repaired != backwardRepairs.end()) return repaired->second;
+        }
+        return cell < index->size ? index->backward[key] : LANDMARK_UNREACHED;
+    }
+
+    size_t repairs() const {
+        return forwardRepairs.size() + backwardRepairs.size();
+    }
+};
+
+/**
+ * Edge changes in version order, in fixed blocks shared with the snapshots. A snapshot copies the block
+ * pointers and the count when published, the writers only append behind that count and drop whole blocks
+ * from the front, so no change a snapshot reads is ever written again.
+ */
+class EdgeChangeLog {
+private:
+    struct Block {
+        EdgeChange changes[EDGE_CHANGE_BLOCK];
+    };
+
+    vector<shared_ptr<Block>> blocks;
+    size_t count;
+public:
+    EdgeChangeLog() : count(0) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    const EdgeChange &operator[](size_t position) const {
+        return blocks[position / EDGE_CHANGE_BLOCK]->changes[position % EDGE_CHANGE_BLOCK];
+    }
+
+    // Position of the first change after the version
+    size_t after(uint64_t version) const;
+
+    void push_back(const EdgeChange &change);
+
+    // Drops the oldest blocks while at least the given changes remain, returns the version of the last one dropped
+    uint64_t trim(size_t keep);
+
+    void clear() {
+        blocks.clear();
+        count = 0;
+    }
+
+    size_t memoryUsage() const {
+        return blocks.capacity() * sizeof(shared_ptr<Block>) + blocks.size() * sizeof(Block);
+    }
+};
+
+// Immutable state of one grid version, published by the writers and pinned by a query with one atomic load.
+// Each is built from the previous one and the arcs changed since, sharing all blocks and chunks they left
+// untouched. Queries resolve their locations in it and never touch the grid. The chain graph is built on first use
+class GridSnapshot {
+private:
+    mutable ChainGraph chainGraph;
+    mutable atomic<bool> chainGraphBuilt;
+    mutable mutex chainGraphMutex;
+public:
+    uint64_t version;
+    GridGraph graph;
+    SnapshotCellIndex cellIndex;        // cell id -> cell index
+    EdgeChangeLog edgeChanges;          // changes after edgeChangesSince up to the version
+    uint64_t edgeChangesSince;
+
+    GridSnapshot() : chainGraphBuilt(false), version(0), edgeChangesSince(0) {}
+
+    // Cell of the location like GridData::getPointCellId, from the representative points of the snapshot
+    uint64_t getPointCellId(const Point &point) const;
+
+    uint32_t getCellIndex(uint64_t cellId) const;
+
+    const ChainGraph &getChainGraph() const {
+        if (!chainGraphBuilt.load(memory_order_acquire)) {
+            lock_guard<mutex> lock(chainGraphMutex);
+            if (!chainGraphBuilt.load(memory_order_relaxed)) {
+                chainGraph.build(graph);
+                chainGraphBuilt.store(true, memory_order_release);
+            }
+        }
+        return chainGraph;
+    }
+
+    // Chain graph when a query has built it already, nullptr otherwise
+    const ChainGraph *builtChainGraph() const {
+        return chainGraphBuilt.load(memory_order_acquire) ? &chainGraph : nullptr;
+    }
+};
+
+// Shortest path tree of a recently queried OneToAll origin at a grid version
+struct PathTree {
+    mutex lock;
+    uint64_t originCellId;
+    uint32_t originIndex;
+    uint64_t version;
+    bool built;
+    vector<uint64_t> distances;     // cell index -> distance, UNREACHED when not reachable
+    uint64_t total;
+
+    explicit PathTree(uint64_t originCellId) :
+            originCellId(originCellId), originIndex(NO_CELL), version(0), built(false), total(0) {}
+};
+
+/**
+ * Shortest path trees of the origins queried repeatedly by OneToAll. A tree is updated to the edge
+ * changes since its version in the style of Ramalingam-Reps: increased arcs first invalidate the cells
+ * that lost all their shortest paths, decreased and added arcs then propagate shorter distances.
+ */
+class PathTreeCache {
+private:
+    mutex treesMutex;
+    list<shared_ptr<PathTree>> trees;   // most recently queried first
+
+    static void rebuild(PathTree &tree, const GridGraph &graph, uint32_t originIndex);
+
+    static bool update(PathTree &tree, const GridSnapshot &snapshot);
+public:
+    // Total length from the origin in the snapshot, the search is used for origins without a tree
+    uint64_t totalLength(const GridSnapshot &snapshot, uint64_t originCellId, uint32_t originIndex,
+                         const function<uint64_t()> &search);
+
+    void clear();
 };
 
 class GridData {
 private:
+    atomic<shared_ptr<const GridSnapshot>> snapshot;
+    mutex snapshotMutex;
+    vector<ChangedArc> changedArcs;     // arcs the next published graph takes from the grid
+    bool layoutChanged;                 // cells renumbered or reset, the next graph is built from scratch
 public:
     vector<ankerl::unordered_dense::map<uint64_t, Cell>> cells;
-
-    GridData() {
+    vector<uint64_t> cellIds;   // cell index -> cell id
+    CellTileIndex cellIndex;    // cell id -> cell index when resolving through tiles
+    array<EdgeIndex, CHUNKS> edgeIndex;     // edges of high-degree cells by the chunk of the cell
+    array<EdgeIndex, CHUNKS> inEdgeIndex;   // in-edges of high-degree cells by the chunk of the cell
+    ChunkLocks chunkLocks;
+    mutex cellIdsMutex;
+    mutex edgeChangesMutex;
+    atomic<uint64_t> version;
+    QueryCache queryCache;
+    PathTreeCache pathTrees;
+    EdgeChangeLog edgeChanges;          // changes after edgeChangesSince in version order
+    uint64_t edgeChangesSince;
+    atomic<shared_ptr<const LandmarkIndex>> landmarks;
+    atomic<bool> landmarksBuilding;
+    shared_ptr<const LandmarkBounds> landmarkBounds;    // bounds of the latest version repaired
+    mutex landmarkBoundsMutex;
+
+<<<<<<< HEAD
+    GridData() : snapshot(make_shared<const GridSnapshot>()), layoutChanged(true), version(0), edgeChangesSince(0) {
+=======
+    GridData() : snapshot(make_shared<const GridSnapshot>()), version(0), edgeChangesSince(0),
+                 landmarksBuilding(false) {
+>>>>>>> e4b7306 ([user-021] Add an ALT landmark index for OneToOne search)
         for (int i = 0; i < CHUNKS; i++) {
             ankerl::unordered_dense::map<uint64_t, Cell> newMap;
             newMap.reserve(120000 / CHUNKS);
@@ -107,25 +793,79 @@ public:
 
     uint64_t getPointCellId(Point &point);
 
+    uint32_t getCellIndex(uint64_t cellId);
+
     void addEdge(GridStats &gridStats, uint64_t &originCellId, uint64_t &destinationCellId, uint64_t length);
 
     void addPoint(GridStats &gridStats, Point &point, uint64_t &cellId);
 
+    // Resolves and adds all locations of a walk, pointCellIds receives the cell of each location
+    void addWalkPoints(GridStats &gridStats, vector<Point> &points, vector<uint64_t> &pointCellIds);
+
+    void recordEdgeChange(uint32_t originIndex, uint32_t destinationIndex, uint64_t oldWeight);
+
+    void recordArcChange(uint32_t originIndex, uint32_t destinationIndex);
+
     void resetGrid(GridStats &gridStats);
 
+    // Latest published snapshot
+    shared_ptr<const GridSnapshot> getSnapshot() const {
+        return snapshot.load(memory_order_acquire);
+    }
+
+    // Publishes the snapshot of the current version unless it is already, the caller excludes walks
+    shared_ptr<const GridSnapshot> publishSnapshot();
+
+    // Bounds of the landmark index on the snapshot, the index has to cover it
+    shared_ptr<const LandmarkBounds> getLandmarkBounds(const shared_ptr<const LandmarkIndex> &index,
+                                                       const GridSnapshot &snapshot);
+
+    GridMemory memoryUsage();
+
     void logGridGraph();
+
+    void logGridMemory();
 };
 
 // processing
-uint64_t dijkstra(GridData &gridData, uint64_t &originCellId, uint64_t &destinationCellId, bool oneToAll);
+template<typename Queue = SearchQueue>
+uint64_t dijkstra(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex, bool oneToAll);
+
+template<typename Queue = SearchQueue>
+uint64_t bidirectionalDijkstra(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex);
+
+template<typename Queue = SearchQueue>
+uint64_t aStar(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex);
+
+template<typename Queue = SearchQueue>
+uint64_t landmarkAStar(const GridGraph &graph, const LandmarkBounds &bounds, uint32_t originIndex,
+                       uint32_t destinationIndex);
+
+template<typename Queue = SearchQueue>
+uint64_t chainDijkstra(const GridGraph &graph, const ChainGraph &chainGraph, uint32_t originIndex);
+
+template<typename Queue = SearchQueue>
+uint64_t dijkstraToMany(const GridGraph &graph, uint32_t originIndex,
+                        const ankerl::unordered_dense::map<uint32_t, uint32_t> &targets, bool exhaustive,
+                        vector<uint64_t> &targetDistances);
+
+uint64_t deltaStepping(const GridGraph &graph, const ChainGraph &chainGraph, uint32_t originIndex,
+                       ThreadPool &pool, uint32_t helpers);
 
 void processWalk(GridData &gridData, GridStats &gridStats, const esw::Walk &walk);
 
 void processReset(GridData &gridData, GridStats &gridStats);
 
+// Applies the queued walks and resets in batches, runs on the single writer thread forever
+void runIngestion(GridData &gridData, GridStats &gridStats);
+
 uint64_t processOneToOne(GridData &gridData, GridStats &gridStats, const esw::OneToOne &oneToOne);
 
 uint64_t processOneToAll(GridData &gridData, GridStats &gridStats, const esw::OneToAll &oneToAll);
 
+vector<uint64_t> processManyToMany(GridData &gridData, GridStats &gridStats, const esw::ManyToMany &manyToMany);
+
+// Publishes the snapshot of the walks applied so far, the server does so before it answers them
+void publishWalks(GridData &gridData);
 
 #endif //GRID_MODEL_HH
@@ -0,0 +1,150 @@
+
+#include "GridModel.hh"
+#include "ThreadTeam.hh"
+
+// Global variables -------------------------------------------------------------------------------
+//#define PARALLEL_SEARCH_LOGGER
+PrefixedLogger parallelLogger = PrefixedLogger("[PARALLEL  ]", true);
+
+// Bucket width in millimetres, zero picks the mean arc weight of the chain graph
+#ifndef DELTA_STEPPING_WIDTH
+#define DELTA_STEPPING_WIDTH 0
+#endif
+
+// Frontier cells a team member claims at once
+#define DELTA_STEPPING_CHUNK 256
+// Below this many cells the team costs more than it saves
+#define DELTA_STEPPING_MIN_CELLS 4096
+
+// Per-thread state of the delta-stepping searches coordinated by this thread
+struct DeltaWorkspace {
+    vector<uint64_t> distances;                             // shared with the team, updated atomically
+    vector<uint64_t> relaxed;                               // distance the light arcs were relaxed with
+    vector<vector<uint32_t>> buckets;                       // bucket -> cells, stale entries are skipped
+    size_t bucketCount;
+    vector<uint32_t> frontier;
+    vector<uint32_t> bucketCells;
+    vector<vector<pair<uint32_t, uint64_t>>> improved;      // team member -> improved cells
+};
+
+thread_local DeltaWorkspace deltaWorkspace;
+
+// Class definition -------------------------------------------------------------------------------
+/**
+ * Delta-stepping over the chain graph. Cells are kept in buckets of the given width by distance, the
+ * lowest bucket is emptied by relaxing the light arcs of its cells in parallel until no cell re-enters
+ * it, then the heavy arcs of all its cells are relaxed at once. Distances of a finished bucket are
+ * final, so the junctions are summed exactly like in the sequential search.
+ */
+uint64_t deltaStepping(const GridGraph &graph, const ChainGraph &chainGraph, uint32_t originIndex,
+                       ThreadPool &pool, uint32_t helpers) {
+    // Unknown origin has no outgoing edges
+    if (originIndex == NO_CELL) return 0;
+    if (helpers == 0 || chainGraph.size() < DELTA_STEPPING_MIN_CELLS) {
+        return chainDijkstra(graph, chainGraph, originIndex);
+    }
+#ifdef PARALLEL_SEARCH_LOGGER
+    parallelLogger.debug("--- Delta-stepping from %u to all with %u helpers ---", originIndex, helpers);
+#endif
+
+    ChainOrigin origin = chainGraph.locate(graph, originIndex);
+    if (origin.junction == NO_CELL) return origin.sum;
+
+    const uint64_t width = DELTA_STEPPING_WIDTH > 0 ? DELTA_STEPPING_WIDTH : chainGraph.meanWeight;
+    DeltaWorkspace &ws = deltaWorkspace;
+    ws.distances.assign(chainGraph.size(), UNREACHED);
+    ws.relaxed.assign(chainGraph.size(), UNREACHED);
+    ws.bucketCount = 0;
+
+    ThreadTeam team(pool, helpers);
+    if (ws.improved.size() < team.size()) {
+        ws.improved.resize(team.size());
+    }
+
+    auto enqueue = [&ws, width](uint32_t index, uint64_t distance) {
+        size_t bucket = distance / width;
+        if (bucket >= ws.buckets.size()) ws.buckets.resize(bucket + 1);
+        ws.bucketCount = max(ws.bucketCount, bucket + 1);
+        ws.buckets[bucket].push_back(index);
+    };
+
+    // Only the last improvement of a cell is still its distance
+    auto collect = [&ws, &team, &enqueue]() {
+        for (uint32_t member = 0; member < team.size(); member++) {
+            for (const auto &[index, distance]: ws.improved[member]) {
+                if (ws.distances[index] == distance) enqueue(index, distance);
+            }
+            ws.improved[member].clear();
+        }
+    };
+
+    bool light = true;
+    function<void(uint32_t, size_t, size_t)> relax = [&](uint32_t member, size_t begin, size_t end) {
+        auto &improved = ws.improved[member];
+        for (size_t i = begin; i < end; i++) {
+            uint32_t index = ws.frontier[i];
+            uint64_t distance = atomic_ref<uint64_t>(ws.distances[index]).load(memory_order_relaxed);
+
+            for (uint32_t arc = chainGraph.offsets[index]; arc < chainGraph.offsets[index + 1]; arc++) {
+                const auto &[neighborIndex, weight] = chainGraph.arcs[arc];
+                if ((weight <= width) != light) continue;
+
+                uint64_t dist = distance + weight;
+                atomic_ref<uint64_t> neighbor(ws.distances[neighborIndex]);
+                uint64_t current = neighbor.load(memory_order_relaxed);
+                while (dist < current) {
+                    if (neighbor.compare_exchange_weak(current, dist, memory_order_relaxed)) {
+                        improved.push_back({neighborIndex, dist});
+                        break;
+                    }
+                }
+            }
+        }
+    };
+
+    uint64_t sum = origin.sum;
+    ws.distances[origin.junction] = origin.distance;
+    enqueue(origin.junction, origin.distance);
+
+    for (size_t bucket = 0; bucket < ws.bucketCount; bucket++) {
+        ws.bucketCells.clear();
+
+        light = true;
+        while (!ws.buckets[bucket].empty()) {
+            ws.frontier.clear();
+            swap(ws.frontier, ws.buckets[bucket]);
+
+            // Keep the cells still in this bucket whose current distance was not relaxed yet
+            size_t kept = 0;
+            for (uint32_t index: ws.frontier) {
+                uint64_t distance = ws.distances[index];
+                if (distance / width != bucket || ws.relaxed[index] == distance) continue;
+                ws.relaxed[index] = distance;
+                ws.frontier[kept++] = index;
+                ws.bucketCells.push_back(index);
+            }
+            ws.frontier.resize(kept);
+
+            team.parallelFor(ws.frontier.size(), DELTA_STEPPING_CHUNK, relax);
+            collect();
+        }
+
+        // Distances of the bucket are final, a cell relaxed several times is settled once
+        ws.frontier.clear();
+        for (uint32_t index: ws.bucketCells) {
+            if (ws.relaxed[index] == UNREACHED) continue;
+            ws.relaxed[index] = UNREACHED;
+            ws.frontier.push_back(index);
+            sum += chainGraph.settledSum(index, ws.distances[index], origin);
+        }
+
+        light = false;
+        team.parallelFor(ws.frontier.size(), DELTA_STEPPING_CHUNK, relax);
+        collect();
+    }
+
+#ifdef PARALLEL_SEARCH_LOGGER
+    parallelLogger.debug("Delta-stepping went through %lu buckets of width %lu", ws.bucketCount, width);
+#endif
+    return sum;
+}
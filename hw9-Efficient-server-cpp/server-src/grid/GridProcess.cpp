@@ -1,6 +1,9 @@
 
 #include "GridModel.hh"
+#include "GridStore.hh"
+#include "ThreadTeam.hh"
 #include <chrono>
+#include <thread>
 
 // Global variables -------------------------------------------------------------------------------
 //#define PROTO_TIME_LOGGER
@@ -10,32 +13,155 @@
 PrefixedLogger protoLogger = PrefixedLogger("[PROTOBUF  ]", true);
 
 std::shared_mutex rwLock;
+IngestQueue ingestQueue;
+
+extern ThreadPool resourcePool1;
 
 #ifdef PROTO_TIME_LOGGER
 uint64_t walkTime = 0;
 uint64_t oneToOneTime = 0;
 uint64_t oneToAllTime = 0;
+uint64_t manyToManyTime = 0;
 #endif
 
 // Class definition -------------------------------------------------------------------------------
-void processWalk(GridData &gridData, GridStats &gridStats, const esw::Walk &walk) {
-#ifdef PROTO_PROCESS_LOGGER
-    protoLogger.debug("Processing Walk message");
+/**
+ * Concurrent walks share rwLock and exclude each other by the chunk locks, the readers of the grid then
+ * take it exclusively. Readers are the writers publishing the snapshot of their walks and the snapshot
+ * writer. Queries search the published snapshot without the lock.
+ */
+static void lockWalk() {
+#ifdef ENABLE_CONCURRENT_INGESTION
+    rwLock.lock_shared();
+#else
+    rwLock.lock();
 #endif
-#ifdef PROTO_TIME_LOGGER
-    auto start = std::chrono::high_resolution_clock::now();
+}
+
+static void unlockWalk() {
+#ifdef ENABLE_CONCURRENT_INGESTION
+    rwLock.unlock_shared();
+#else
+    rwLock.unlock();
 #endif
+}
+
+static void lockRead() {
+#ifdef ENABLE_CONCURRENT_INGESTION
     rwLock.lock();
+#else
+    rwLock.lock_shared();
+#endif
+}
+
+static void unlockRead() {
+#ifdef ENABLE_CONCURRENT_INGESTION
+    rwLock.unlock();
+#else
+    rwLock.unlock_shared();
+#endif
+}
+
+#ifdef ENABLE_CONCURRENT_INGESTION
+// Resolves and adds a location under the locks of the chunks of all cells it may resolve to
+static uint64_t addLocation(GridData &gridData, GridStats &gridStats, Point &point) {
+    uint64_t probableCoordX = point.x / 500;
+    uint64_t probableCoordY = point.y / 500;
+    ChunkLocks::Set chunks;
+    chunks.add((probableCoordX << 32) | probableCoordY);
+    for (const auto &comb: precomputedNeighbourPairs) {
+        chunks.add(((probableCoordX + comb.first) << 32) | (probableCoordY + comb.second));
+    }
+
+    gridData.chunkLocks.lock(chunks);
+    uint64_t cellId = gridData.getPointCellId(point);
+    gridData.addPoint(gridStats, point, cellId);
+    gridData.chunkLocks.unlock(chunks);
+    return cellId;
+}
+
+static void addEdge(GridData &gridData, GridStats &gridStats, uint64_t originCellId, uint64_t destinationCellId,
+                    uint64_t length) {
+    ChunkLocks::Set chunks;
+    chunks.add(originCellId);
+    chunks.add(destinationCellId);
+
+    gridData.chunkLocks.lock(chunks);
+    gridData.addEdge(gridStats, originCellId, destinationCellId, length);
+    gridData.chunkLocks.unlock(chunks);
+}
+#endif
+
+// Pool threads free to help a request, the epoll loop and the request itself occupy two of them
+static uint32_t poolHelpers() {
+    uint32_t threads = min<size_t>(thread::hardware_concurrency(), resourcePool1.size() - 1);
+    return threads > 0 ? threads - 1 : 0;
+}
+
+#ifdef ENABLE_LANDMARK_SEARCH
+/**
+ * Landmark index the snapshot can be searched with, nullptr while there is none. An index is rebuilt on a
+ * pool thread once the walks since it changed enough edges or the log no longer reaches back to it, the
+ * queries keep using the repaired old one meanwhile.
+ */
+static shared_ptr<const LandmarkIndex> landmarksFor(GridData &gridData,
+                                                    const shared_ptr<const GridSnapshot> &snapshot) {
+    shared_ptr<const LandmarkIndex> index = gridData.landmarks.load(memory_order_acquire);
+    bool usable = index && index->covers(*snapshot);
+
+    bool stale = !usable;
+    if (usable) {
+        auto first = partition_point(snapshot->edgeChanges.begin(), snapshot->edgeChanges.end(),
+                                     [&](const EdgeChange &change) { return change.version <= index->version; });
+        stale = snapshot->edgeChanges.end() - first >= LANDMARK_REBUILD_CHANGES;
+    }
+    if (stale && snapshot->graph.size() > 0 && (!index || index->version < snapshot->version) &&
+        !gridData.landmarksBuilding.exchange(true)) {
+        resourcePool1.run([&gridData, snapshot]() {
+            auto next = make_shared<LandmarkIndex>();
+            next->build(snapshot->graph);
+            gridData.landmarks.store(std::move(next), memory_order_release);
+            gridData.landmarksBuilding.store(false);
+        }, -1);
+    }
+    return usable ? index : nullptr;
+}
+#endif
+
+// Applies a walk to the grid, the caller holds the walk lock
+static void applyWalk(GridData &gridData, GridStats &gridStats, const esw::Walk &walk) {
     gridStats.walk_count++;
 
     const auto &locations = walk.locations();
     const auto &lengths = walk.lengths();
 
     if (locations.size() < 2 || lengths.size() < 1) {
-        rwLock.unlock();
         return;
     }
 
+#if defined(ENABLE_CONCURRENT_INGESTION)
+    Point origin = {static_cast<uint64_t>(locations.Get(0).x()), static_cast<uint64_t>(locations.Get(0).y())};
+    uint64_t originCellId = addLocation(gridData, gridStats, origin);
+    for (int i = 0; i < locations.size() - 1; ++i) {
+        auto &location = locations.Get(i + 1);
+        Point destination = {static_cast<uint64_t>(location.x()), static_cast<uint64_t>(location.y())};
+        uint64_t destinationCellId = addLocation(gridData, gridStats, destination);
+        addEdge(gridData, gridStats, originCellId, destinationCellId, lengths.Get(i));
+        originCellId = destinationCellId;
+    }
+#elif defined(ENABLE_BATCH_RESOLUTION)
+    static thread_local vector<Point> points;
+    static thread_local vector<uint64_t> pointCellIds;
+    points.clear();
+    for (const auto &location: locations) {
+        points.push_back({static_cast<uint64_t>(location.x()), static_cast<uint64_t>(location.y())});
+    }
+
+    gridData.addWalkPoints(gridStats, points, pointCellIds);
+    for (int i = 0; i < locations.size() - 1; ++i) {
+        gridData.addEdge(gridStats, pointCellIds[i], pointCellIds[i + 1], lengths.Get(i));
+    }
+#else
     auto &location1 = locations.Get(0);
     auto &location2 = locations.Get(1);
     auto &length = lengths.Get(0);
@@ -60,7 +186,19 @@ void processWalk(GridData &gridData, GridStats &gridStats, const esw::Walk &walk
         gridData.addPoint(gridStats, destination, destinationCellId);
         gridData.addEdge(gridStats, originCellId, destinationCellId, len);
     }
-    rwLock.unlock();
+#endif
+}
+
+void processWalk(GridData &gridData, GridStats &gridStats, const esw::Walk &walk) {
+#ifdef PROTO_PROCESS_LOGGER
+    protoLogger.debug("Processing Walk message");
+#endif
+#ifdef PROTO_TIME_LOGGER
+    auto start = std::chrono::high_resolution_clock::now();
+#endif
+    lockWalk();
+    applyWalk(gridData, gridStats, walk);
+    unlockWalk();
 #ifdef PROTO_PROCESS_LOGGER
     protoLogger.debug("Processed Walk message");
 #endif
@@ -77,29 +215,49 @@ uint64_t processOneToOne(GridData &gridData, GridStats &gridStats, const esw::On
 #endif
 #ifdef PROTO_TIME_LOGGER
     auto start = std::chrono::high_resolution_clock::now();
-#endif
-#ifdef PROTO_LOCK_LOGGER
-    auto start = std::chrono::high_resolution_clock::now();
-#endif
-    rwLock.lock_shared();
-#ifdef PROTO_LOCK_LOGGER
-    auto stop = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-    protoLogger.debug("Read lock took %llu milliseconds to execute.", duration.count());
 #endif
     gridStats.oneToOne_count++;
 
+    // The query resolves and searches on the pinned snapshot, walks are applied meanwhile
+    shared_ptr<const GridSnapshot> snapshot = gridData.getSnapshot();
+
     const auto &location1 = oneToOne.origin();
     const auto &location2 = oneToOne.destination();
 
     Point origin = {static_cast<uint64_t>(location1.x()), static_cast<uint64_t>(location1.y())};
-    uint64_t originCellId = gridData.getPointCellId(origin);
+    uint64_t originCellId = snapshot->getPointCellId(origin);
 
     Point destination = {static_cast<uint64_t>(location2.x()), static_cast<uint64_t>(location2.y())};
-    uint64_t destinationCellId = gridData.getPointCellId(destination);
+    uint64_t destinationCellId = snapshot->getPointCellId(destination);
 
-    uint64_t shortestPath = dijkstra(gridData, originCellId, destinationCellId, ONE_TO_ONE);
-    rwLock.unlock_shared();
+    uint32_t originIndex = snapshot->getCellIndex(originCellId);
+    uint32_t destinationIndex = snapshot->getCellIndex(destinationCellId);
+
+#ifdef ENABLE_LANDMARK_SEARCH
+    shared_ptr<const LandmarkIndex> landmarks = landmarksFor(gridData, snapshot);
+#endif
+    auto search = [&]() {
+#ifdef ENABLE_LANDMARK_SEARCH
+        // Without an index yet the configured search below answers
+        if (landmarks) {
+            shared_ptr<const LandmarkBounds> bounds = gridData.getLandmarkBounds(landmarks, *snapshot);
+            return landmarkAStar(snapshot->graph, *bounds, originIndex, destinationIndex);
+        }
+#endif
+#if defined(ENABLE_ASTAR_SEARCH)
+        return aStar(snapshot->graph, originIndex, destinationIndex);
+#elif defined(ENABLE_BIDIRECTIONAL_SEARCH)
+        return bidirectionalDijkstra(snapshot->graph, originIndex, destinationIndex);
+#else
+        return dijkstra(snapshot->graph, originIndex, destinationIndex, ONE_TO_ONE);
+#endif
+    };
+#ifdef ENABLE_QUERY_CACHE
+    QueryKey key = {originCellId, destinationCellId, ONE_TO_ONE};
+    uint64_t shortestPath = gridData.queryCache.getOrCompute(key, snapshot->version, search);
+#else
+    uint64_t shortestPath = search();
+#endif
 
 #ifdef PROTO_STATS_LOGGER
     protoLogger.warn("Shortest path: %llu from: %llu to: %llu", shortestPath, originCellId, destinationCellId);
@@ -122,28 +280,42 @@ uint64_t processOneToAll(GridData &gridData, GridStats &gridStats, const esw::On
 #endif
 #ifdef PROTO_TIME_LOGGER
     auto start = std::chrono::high_resolution_clock::now();
-#endif
-#ifdef PROTO_LOCK_LOGGER
-    auto start = std::chrono::high_resolution_clock::now();
-#endif
-    rwLock.lock_shared();
-#ifdef PROTO_LOCK_LOGGER
-    auto stop = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-    protoLogger.debug("Read lock took %llu milliseconds to execute.", duration.count());
 #endif
     gridStats.oneToAll_count++;
+    shared_ptr<const GridSnapshot> snapshot = gridData.getSnapshot();
 
     const auto &location1 = oneToAll.origin();
 
     Point origin = {static_cast<uint64_t>(location1.x()), static_cast<uint64_t>(location1.y())};
-    uint64_t originCellId = gridData.getPointCellId(origin);
+    uint64_t originCellId = snapshot->getPointCellId(origin);
 
-    uint64_t shortestPath = dijkstra(gridData, originCellId, originCellId, ONE_TO_ALL);
-    rwLock.unlock_shared();
+    uint32_t originIndex = snapshot->getCellIndex(originCellId);
+
+    function<uint64_t()> search = [&snapshot, originIndex]() {
+#if defined(ENABLE_PARALLEL_SEARCH)
+        return deltaStepping(snapshot->graph, snapshot->getChainGraph(), originIndex, resourcePool1, poolHelpers());
+#elif defined(ENABLE_CHAIN_COMPRESSION)
+        return chainDijkstra(snapshot->graph, snapshot->getChainGraph(), originIndex);
+#else
+        return dijkstra(snapshot->graph, originIndex, NO_CELL, ONE_TO_ALL);
+#endif
+    };
+#ifdef ENABLE_INCREMENTAL_SEARCH
+    search = [&gridData, &snapshot, originCellId, originIndex, fullSearch = search]() {
+        return gridData.pathTrees.totalLength(*snapshot, originCellId, originIndex, fullSearch);
+    };
+#endif
+#ifdef ENABLE_QUERY_CACHE
+    QueryKey key = {originCellId, 0, ONE_TO_ALL};
+    uint64_t shortestPath = gridData.queryCache.getOrCompute(key, snapshot->version, search);
+#else
+    uint64_t shortestPath = search();
+#endif
 
     gridData.logGridGraph();
+    gridData.logGridMemory();
     gridStats.logGridStats();
+    gridData.queryCache.logCacheStats();
 
 #ifdef PROTO_STATS_LOGGER
     protoLogger.warn("Total path: %llu from: %llu", shortestPath, originCellId);
@@ -162,8 +334,162 @@ uint64_t processOneToAll(GridData &gridData, GridStats &gridStats, const esw::On
     return shortestPath;
 }
 
+vector<uint64_t> processManyToMany(GridData &gridData, GridStats &gridStats, const esw::ManyToMany &manyToMany) {
+#ifdef PROTO_PROCESS_LOGGER
+    protoLogger.info("Processing ManyToMany message");
+#endif
+#ifdef PROTO_TIME_LOGGER
+    auto start = std::chrono::high_resolution_clock::now();
+#endif
+    gridStats.manyToMany_count++;
+    shared_ptr<const GridSnapshot> snapshot = gridData.getSnapshot();
+
+    const auto &origins = manyToMany.origins();
+    const auto &destinations = manyToMany.destinations();
+
+    vector<uint32_t> originIndices;
+    originIndices.reserve(origins.size());
+    for (const auto &location: origins) {
+        Point origin = {static_cast<uint64_t>(location.x()), static_cast<uint64_t>(location.y())};
+        originIndices.push_back(snapshot->getCellIndex(snapshot->getPointCellId(origin)));
+    }
+
+    // Destinations in the same cell share a target, an unknown one needs the sum of a complete search
+    ankerl::unordered_dense::map<uint32_t, uint32_t> targets;
+    vector<uint32_t> columnTargets;
+    columnTargets.reserve(destinations.size());
+    bool exhaustive = false;
+    for (const auto &location: destinations) {
+        Point destination = {static_cast<uint64_t>(location.x()), static_cast<uint64_t>(location.y())};
+        uint32_t destinationIndex = snapshot->getCellIndex(snapshot->getPointCellId(destination));
+        if (destinationIndex == NO_CELL) {
+            exhaustive = true;
+            columnTargets.push_back(NO_CELL);
+            continue;
+        }
+        columnTargets.push_back(targets.try_emplace(destinationIndex, targets.size()).first->second);
+    }
+
+    // One forward search per origin answers its whole row, rows are searched by a team of pool threads
+    const GridGraph &graph = snapshot->graph;
+    size_t columns = destinations.size();
+    vector<uint64_t> distances(origins.size() * columns);
+    ThreadTeam team(resourcePool1, min<size_t>(poolHelpers(), max<size_t>(originIndices.size(), 1) - 1));
+    team.parallelFor(originIndices.size(), 1, [&](uint32_t, size_t begin, size_t end) {
+        vector<uint64_t> targetDistances;
+        for (size_t row = begin; row < end; row++) {
+            uint64_t sum = dijkstraToMany(graph, originIndices[row], targets, exhaustive, targetDistances);
+            for (size_t column = 0; column < columns; column++) {
+                uint32_t target = columnTargets[column];
+                uint64_t distance = target == NO_CELL ? UNREACHED : targetDistances[target];
+                distances[row * columns + column] = distance == UNREACHED ? sum : distance;
+            }
+        }
+    });
+
+#ifdef PROTO_PROCESS_LOGGER
+    protoLogger.info("Processed ManyToMany message");
+#endif
+#ifdef PROTO_TIME_LOGGER
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    manyToManyTime += duration.count();
+    protoLogger.debug("Cumulative manyToMany took %llu milliseconds to execute.", manyToManyTime);
+#endif
+    return distances;
+}
+
 void processReset(GridData &gridData, GridStats &gridStats) {
     rwLock.lock();
     gridData.resetGrid(gridStats);
     rwLock.unlock();
 }
+
+void publishWalks(GridData &gridData) {
+    // Walks wait for the update, queries keep searching the previous snapshot meanwhile
+#ifdef PROTO_LOCK_LOGGER
+    auto start = std::chrono::high_resolution_clock::now();
+#endif
+    lockRead();
+#ifdef PROTO_LOCK_LOGGER
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    protoLogger.debug("Read lock took %llu milliseconds to execute.", duration.count());
+#endif
+    gridData.publishSnapshot();
+    unlockRead();
+}
+
+#ifdef ENABLE_BATCHED_INGESTION
+// Applies the requests of the batch from the first one on, they reach the log in the order they are applied
+static void applyBatch(GridData &gridData, GridStats &gridStats, vector<IngestRequest> &batch, size_t first) {
+    // All requests accumulated meanwhile are applied under one acquisition of the lock
+    lockWalk();
+    for (size_t i = first; i < batch.size(); i++) {
+        const esw::Request &request = batch[i].request;
+        if (request.has_walk()) {
+            applyWalk(gridData, gridStats, request.walk());
+        } else if (request.has_reset()) {
+            gridData.resetGrid(gridStats);
+        }
+#ifdef ENABLE_WRITE_AHEAD_LOG
+        writeAheadLog.append(request);
+#endif
+    }
+    unlockWalk();
+#ifdef PROTO_PROCESS_LOGGER
+    protoLogger.debug("Applied a batch of %lu requests", batch.size() - first);
+#endif
+}
+
+void runIngestion(GridData &gridData, GridStats &gridStats) {
+    vector<IngestRequest> batch;
+    while (true) {
+        batch.clear();
+        ingestQueue.popBatch(batch, INGEST_MAX_BATCH);
+        applyBatch(gridData, gridStats, batch, 0);
+
+#ifdef ENABLE_WRITE_AHEAD_LOG
+        // Requests arriving until the sync interval has passed share its fdatasync
+        auto due = writeAheadLog.lastSync() + chrono::microseconds(WAL_SYNC_INTERVAL_US);
+        if (chrono::steady_clock::now() < due) {
+            this_thread::sleep_until(due);
+            size_t applied = batch.size();
+            ingestQueue.popBatch(batch, applied + INGEST_MAX_BATCH, false);
+            applyBatch(gridData, gridStats, batch, applied);
+        }
+        // Acknowledged requests survive a crash, the group is answered only once it is durable
+        if (!writeAheadLog.sync()) {
+            protoLogger.error("Cannot sync the write-ahead log");
+        }
+#endif
+
+        // A query sent after the answer of a request finds it applied in the published snapshot
+        publishWalks(gridData);
+        for (auto &item: batch) item.done();
+    }
+}
+#endif
+
+void runSnapshots(GridData &gridData, const string &path) {
+    // A snapshot loaded at startup is on disk already
+    uint64_t written = gridData.version;
+    while (true) {
+        this_thread::sleep_for(chrono::milliseconds(SNAPSHOT_INTERVAL_MS));
+        if (gridData.version == written) continue;
+
+        // Walks wait only for the copy of the grid, the file is written without the lock. Walks after
+        // the copy go to the next generation of the log, the snapshot replaces the ones before it
+        lockRead();
+        uint64_t version = gridData.version;
+        uint64_t generation = writeAheadLog.rotate();
+        vector<char> image = captureSnapshot(gridData, generation);
+        unlockRead();
+        if (writeSnapshot(image, path)) {
+            written = version;
+            writeAheadLog.removeBefore(generation);
+        } else {
+            protoLogger.error("Cannot write the snapshot to %s", path.c_str());
+        }
+    }
+}
@@ -0,0 +1,221 @@
+#ifndef GRID_QUEUE_HH
+#define GRID_QUEUE_HH
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+// Global variables -------------------------------------------------------------------------------
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+/**
+ * Priority queue policies of the shortest path searches. Every policy provides prepare(), empty(),
+ * size(), push(), top() and pop() over (key, cell index) pairs. Lazy policies may return stale
+ * entries of already settled cells, the searches skip those.
+ */
+
+// Binary heap with lazy deletion, improved cells are pushed again
+class BinaryHeapQueue {
+private:
+    vector<pair<uint64_t, uint32_t>> heap;
+public:
+    void prepare(uint32_t) {
+        heap.clear();
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    void push(uint64_t key, uint32_t node) {
+        heap.push_back({key, node});
+        push_heap(heap.begin(), heap.end(), greater<>());
+    }
+
+    pair<uint64_t, uint32_t> top() {
+        return heap.front();
+    }
+
+    void pop() {
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        heap.pop_back();
+    }
+};
+
+// Radix heap with lazy deletion, keys pushed must not be lower than the last popped key
+class RadixHeapQueue {
+private:
+    vector<pair<uint64_t, uint32_t>> buckets[65];
+    uint64_t last;
+    size_t count;
+
+    // Bucket of a key is given by the highest bit in which it differs from the last popped key
+    static int bucketOf(uint64_t key, uint64_t last) {
+        return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+    }
+
+    // Moves the lowest non-empty bucket down so that bucket zero holds the minimum
+    void pull() {
+        if (!buckets[0].empty()) return;
+
+        int index = 1;
+        while (buckets[index].empty()) index++;
+
+        uint64_t minimum = numeric_limits<uint64_t>::max();
+        for (const auto &entry: buckets[index]) {
+            minimum = min(minimum, entry.first);
+        }
+        last = minimum;
+
+        for (const auto &entry: buckets[index]) {
+            buckets[bucketOf(entry.first, last)].push_back(entry);
+        }
+        buckets[index].clear();
+    }
+
+public:
+    RadixHeapQueue() : last(0), count(0) {}
+
+    void prepare(uint32_t) {
+        for (auto &bucket: buckets) {
+            bucket.clear();
+        }
+        last = 0;
+        count = 0;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    void push(uint64_t key, uint32_t node) {
+        buckets[bucketOf(key, last)].push_back({key, node});
+        count++;
+    }
+
+    pair<uint64_t, uint32_t> top() {
+        pull();
+        return buckets[0].back();
+    }
+
+    void pop() {
+        pull();
+        buckets[0].pop_back();
+        count--;
+    }
+};
+
+// Indexed d-ary heap with decrease-key, every cell is present at most once
+template<unsigned ARITY>
+class IndexedDaryHeapQueue {
+private:
+    vector<pair<uint64_t, uint32_t>> heap;
+    vector<uint32_t> positions;     // cell index -> heap slot, valid only if the slot points back
+
+    bool contains(uint32_t node) const {
+        uint32_t position = positions[node];
+        return position < heap.size() && heap[position].second == node;
+    }
+
+    void place(uint32_t position, const pair<uint64_t, uint32_t> &entry) {
+        heap[position] = entry;
+        positions[entry.second] = position;
+    }
+
+    void siftUp(uint32_t position) {
+        pair<uint64_t, uint32_t> entry = heap[position];
+        while (position > 0) {
+            uint32_t parent = (position - 1) / ARITY;
+            if (heap[parent].first <= entry.first) break;
+            place(position, heap[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void siftDown(uint32_t position) {
+        pair<uint64_t, uint32_t> entry = heap[position];
+        uint32_t size = heap.size();
+        while (true) {
+            uint32_t first = position * ARITY + 1;
+            if (first >= size) break;
+
+            uint32_t best = first;
+            uint32_t end = min(first + ARITY, size);
+            for (uint32_t child = first + 1; child < end; child++) {
+                if (heap[child].first < heap[best].first) best = child;
+            }
+            if (heap[best].first >= entry.first) break;
+
+            place(position, heap[best]);
+            position = best;
+        }
+        place(position, entry);
+    }
+
+public:
+    void prepare(uint32_t size) {
+        heap.clear();
+        if (positions.size() < size) {
+            positions.resize(size, numeric_limits<uint32_t>::max());
+        }
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    // Inserts the cell or decreases its key, a higher key is ignored
+    void push(uint64_t key, uint32_t node) {
+        if (contains(node)) {
+            uint32_t position = positions[node];
+            if (key >= heap[position].first) return;
+            heap[position].first = key;
+            siftUp(position);
+            return;
+        }
+        heap.push_back({key, node});
+        siftUp(heap.size() - 1);
+    }
+
+    pair<uint64_t, uint32_t> top() {
+        return heap.front();
+    }
+
+    void pop() {
+        pair<uint64_t, uint32_t> lastEntry = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = lastEntry;
+            siftDown(0);
+        }
+    }
+};
+
+// Queue used by the server searches
+#if defined(ENABLE_RADIX_QUEUE)
+using SearchQueue = RadixHeapQueue;
+#elif defined(ENABLE_DARY_QUEUE)
+using SearchQueue = IndexedDaryHeapQueue<4>;
+#else
+using SearchQueue = BinaryHeapQueue;
+#endif
+
+#endif //GRID_QUEUE_HH
@@ -0,0 +1,166 @@
+#include "GridModel.hh"
+#include <immintrin.h>
+
+// Global variables -------------------------------------------------------------------------------
+//#define RESOLVE_LOGGER
+PrefixedLogger resolveLogger = PrefixedLogger("[RESOLVE   ]", true);
+
+// Squared distance in square millimetres within which a location joins a neighbouring cell
+#define RESOLVE_RADIUS_SQUARED 250000
+
+// Representative points of the neighbouring cells of one location, lanes follow precomputedNeighbourPairs
+struct NeighbourCandidates {
+    alignas(32) uint64_t x[8];
+    alignas(32) uint64_t y[8];
+    uint64_t ids[8];
+    uint32_t present;   // bit per lane whose cell exists
+};
+
+// Class definition -------------------------------------------------------------------------------
+static uint32_t nearLanesScalar(const NeighbourCandidates &candidates, const Point &point, uint32_t first) {
+    uint32_t near = 0;
+    for (uint32_t lane = first; lane < first + 4; lane++) {
+        uint64_t dx = (point.x > candidates.x[lane]) ? (point.x - candidates.x[lane]) : (candidates.x[lane] - point.x);
+        uint64_t dy = (point.y > candidates.y[lane]) ? (point.y - candidates.y[lane]) : (candidates.y[lane] - point.y);
+        if ((dx * dx + dy * dy) <= RESOLVE_RADIUS_SQUARED) near |= 1u << lane;
+    }
+    return near & candidates.present;
+}
+
+/**
+ * The lanes multiply only the low halves of the differences. Their squares are exact below 2^32 and
+ * the sum wraps like the scalar test, lanes with a wider difference wrap in the squares already and
+ * are handed to the scalar test. Unsigned comparisons flip the sign bits before the signed compare.
+ */
+__attribute__((target("avx2")))
+static __m256i differenceAvx2(__m256i a, __m256i b, __m256i sign) {
+    __m256i greater = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+    return _mm256_blendv_epi8(_mm256_sub_epi64(b, a), _mm256_sub_epi64(a, b), greater);
+}
+
+__attribute__((target("avx2")))
+static uint32_t nearLanesAvx2(const NeighbourCandidates &candidates, const Point &point, uint32_t first) {
+    const __m256i sign = _mm256_set1_epi64x(numeric_limits<int64_t>::min());
+    const __m256i limit = _mm256_xor_si256(_mm256_set1_epi64x(RESOLVE_RADIUS_SQUARED), sign);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i px = _mm256_set1_epi64x(static_cast<int64_t>(point.x));
+    const __m256i py = _mm256_set1_epi64x(static_cast<int64_t>(point.y));
+
+    __m256i dx = differenceAvx2(px, _mm256_load_si256(reinterpret_cast<const __m256i *>(candidates.x + first)), sign);
+    __m256i dy = differenceAvx2(py, _mm256_load_si256(reinterpret_cast<const __m256i *>(candidates.y + first)), sign);
+    __m256i high = _mm256_srli_epi64(_mm256_or_si256(dx, dy), 32);
+    __m256i squared = _mm256_add_epi64(_mm256_mul_epu32(dx, dx), _mm256_mul_epu32(dy, dy));
+    __m256i beyond = _mm256_cmpgt_epi64(_mm256_xor_si256(squared, sign), limit);
+
+    uint32_t near = (~_mm256_movemask_pd(_mm256_castsi256_pd(beyond)) & 0xF) << first;
+    uint32_t wide = (~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(high, zero))) & 0xF) << first;
+
+    wide &= candidates.present;
+    if (wide) near = (near & ~wide) | (nearLanesScalar(candidates, point, first) & wide);
+    return near & candidates.present;
+}
+
+__attribute__((target("sse4.2")))
+static __m128i differenceSse4(__m128i a, __m128i b, __m128i sign) {
+    __m128i greater = _mm_cmpgt_epi64(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+    return _mm_blendv_epi8(_mm_sub_epi64(b, a), _mm_sub_epi64(a, b), greater);
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t nearLanesSse4(const NeighbourCandidates &candidates, const Point &point, uint32_t first) {
+    const __m128i sign = _mm_set1_epi64x(numeric_limits<int64_t>::min());
+    const __m128i limit = _mm_xor_si128(_mm_set1_epi64x(RESOLVE_RADIUS_SQUARED), sign);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i px = _mm_set1_epi64x(static_cast<int64_t>(point.x));
+    const __m128i py = _mm_set1_epi64x(static_cast<int64_t>(point.y));
+
+    uint32_t near = 0;
+    uint32_t wide = 0;
+    for (uint32_t lane = first; lane < first + 4; lane += 2) {
+        __m128i dx = differenceSse4(px, _mm_load_si128(reinterpret_cast<const __m128i *>(candidates.x + lane)), sign);
+        __m128i dy = differenceSse4(py, _mm_load_si128(reinterpret_cast<const __m128i *>(candidates.y + lane)), sign);
+        __m128i high = _mm_srli_epi64(_mm_or_si128(dx, dy), 32);
+        __m128i squared = _mm_add_epi64(_mm_mul_epu32(dx, dx), _mm_mul_epu32(dy, dy));
+        __m128i beyond = _mm_cmpgt_epi64(_mm_xor_si128(squared, sign), limit);
+
+        near |= (~_mm_movemask_pd(_mm_castsi128_pd(beyond)) & 0x3) << lane;
+        wide |= (~_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(high, zero))) & 0x3) << lane;
+    }
+
+    wide &= candidates.present;
+    if (wide) near = (near & ~wide) | (nearLanesScalar(candidates, point, first) & wide);
+    return near & candidates.present;
+}
+
+using NearLanes = uint32_t (*)(const NeighbourCandidates &, const Point &, uint32_t);
+
+static NearLanes selectNearLanes() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return nearLanesAvx2;
+    if (__builtin_cpu_supports("sse4.2")) return nearLanesSse4;
+    return nearLanesScalar;
+}
+
+static const NearLanes nearLanes = selectNearLanes();
+
+// Gathers the four lanes from the first one on
+static void gatherNeighbours(GridData &gridData, const Point &point, NeighbourCandidates &candidates,
+                             uint32_t first) {
+    uint64_t probableCoordX = point.x / 500;
+    uint64_t probableCoordY = point.y / 500;
+
+#ifdef ENABLE_CELL_TILE_INDEX
+    CellTileIndex::Cursor cursor;
+#endif
+    for (uint32_t lane = first; lane < first + 4; lane++) {
+        const auto &comb = precomputedNeighbourPairs[lane];
+        uint64_t neighborCellId = ((probableCoordX + comb.first) << 32) | (probableCoordY + comb.second);
+        candidates.ids[lane] = neighborCellId;
+#ifdef ENABLE_CELL_TILE_INDEX
+        if (gridData.cellIndex.find(neighborCellId, cursor) == NO_CELL) {
+            candidates.x[lane] = candidates.y[lane] = 0;
+            continue;
+        }
+        const Point &neighborPoint = gridData.cellIndex.point(neighborCellId, cursor);
+        candidates.x[lane] = neighborPoint.x;
+        candidates.y[lane] = neighborPoint.y;
+#else
+        auto cellIt = gridData.cells[neighborCellId % CHUNKS].find(neighborCellId);
+        if (cellIt == gridData.cells[neighborCellId % CHUNKS].end()) {
+            candidates.x[lane] = candidates.y[lane] = 0;
+            continue;
+        }
+        const Point neighborPoint = cellIt->second.point();
+        candidates.x[lane] = neighborPoint.x;
+        candidates.y[lane] = neighborPoint.y;
+#endif
+        candidates.present |= 1u << lane;
+    }
+}
+
+/**
+ * Resolves and adds the locations of one walk in order, a location sees the cells added by the
+ * locations before it exactly like with getPointCellId. Neighbours are gathered and tested four at
+ * once, the first neighbour in the probing order within the radius wins, so the second four are
+ * gathered only when none of the first is near.
+ */
+void GridData::addWalkPoints(GridStats &gridStats, vector<Point> &points, vector<uint64_t> &pointCellIds) {
+    NeighbourCandidates candidates;
+    pointCellIds.resize(points.size());
+
+    for (size_t i = 0; i < points.size(); i++) {
+        candidates.present = 0;
+        gatherNeighbours(*this, points[i], candidates, 0);
+        uint32_t near = nearLanes(candidates, points[i], 0);
+        if (!near) {
+            gatherNeighbours(*this, points[i], candidates, 4);
+            near = nearLanes(candidates, points[i], 4);
+        }
+        pointCellIds[i] = near ? candidates.ids[__builtin_ctz(near)]
+                               : ((points[i].x / 500) << 32) | (points[i].y / 500);
+        addPoint(gridStats, points[i], pointCellIds[i]);
+    }
+#ifdef RESOLVE_LOGGER
+    resolveLogger.debug("Resolved %lu locations of a walk", points.size());
+#endif
+}
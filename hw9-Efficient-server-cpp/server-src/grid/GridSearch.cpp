@@ -9,41 +9,54 @@
 PrefixedLogger searchLogger = PrefixedLogger("[SEARCHING ]", true);
 
 // Class definition -------------------------------------------------------------------------------
-uint64_t dijkstra(GridData &gridData, uint64_t &originCellId, uint64_t &destinationCellId, bool oneToAll) {
+thread_local SearchWorkspace searchWorkspace;
+thread_local SearchWorkspace reverseWorkspace;
+
+void SearchWorkspace::prepare(uint32_t size) {
+    if (stamps.size() < size) {
+        stamps.resize(size, 0);
+        distances.resize(size, 0);
+    }
+
+    // Two stamps per search, reached and settled, restart once the counter wraps around
+    epoch += 2;
+    if (epoch == 0) {
+        fill(stamps.begin(), stamps.end(), 0);
+        epoch = 2;
+    }
+}
+
+template<typename Queue>
+uint64_t dijkstra(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex, bool oneToAll) {
 #ifdef SEARCH_TIME_LOGGER
     auto start = std::chrono::high_resolution_clock::now();
 #endif
 #ifdef SEARCH_ALGO_LOGGER
     if (oneToAll) {
-        searchLogger.debug("--- Dijkstra from %llu to all ---", originCellId);
+        searchLogger.debug("--- Dijkstra from %u to all ---", originIndex);
     } else {
-        searchLogger.debug("--- Dijkstra from %llu to %llu ---", originCellId, destinationCellId);
+        searchLogger.debug("--- Dijkstra from %u to %u ---", originIndex, destinationIndex);
     }
 #endif
 #ifdef SEARCH_STATS_LOGGER
     uint64_t maxSums = 0;
     uint64_t maxEdges = 0;
     uint64_t maxPqSize = 0;
-
-    uint64_t heuristicSkips = 0;
 #endif
-    std::vector <std::pair<uint64_t, uint64_t>> vec;
-    vec.reserve(300);
-    ankerl::unordered_dense::map<uint64_t, uint64_t> visited;
-    visited.reserve(115000);
-    ankerl::unordered_dense::map<uint64_t, uint64_t> expandable;
-    expandable.reserve(55000);
-
-    std::priority_queue <
-    std::pair < uint64_t, uint64_t >,
-            std::vector < std::pair < uint64_t, uint64_t >>,
-            std::greater<>
-            > pq(std::greater<>(), vec);
+    // Unknown origin has no outgoing edges
+    if (originIndex == NO_CELL) return 0;
+    if (oneToAll) destinationIndex = NO_CELL;
+
+    static thread_local Queue pq;
+    SearchWorkspace &ws = searchWorkspace;
+    ws.prepare(graph.size());
+    pq.prepare(graph.size());
 
     uint64_t sum = 0;
 
     // Add the source cell to the priority queue
-    pq.push({0, originCellId});
+    ws.reach(originIndex, 0);
+    pq.push(0, originIndex);
 
     // Main loop of Dijkstra's Algorithm
     while (!pq.empty()) {
@@ -53,14 +66,13 @@ uint64_t dijkstra(GridData &gridData, uint64_t &originCellId, uint64_t &destinat
         }
 #endif
         // Get the cell with the minimum distance from the priority queue
-        uint64_t originCurrent = pq.top().first;
-        uint64_t currentCellId = pq.top().second;
+        auto [originCurrent, currentIndex] = pq.top();
         pq.pop();
 
-        if (visited[currentCellId] == 1) continue;
-        visited[currentCellId] = 1;
+        if (ws.settled(currentIndex)) continue;
+        ws.settle(currentIndex);
 
-        if (currentCellId == destinationCellId && !oneToAll) {
+        if (currentIndex == destinationIndex) {
             sum = originCurrent;
             break;
         } else {
@@ -71,56 +83,25 @@ uint64_t dijkstra(GridData &gridData, uint64_t &originCellId, uint64_t &destinat
         }
 
 #ifdef SEARCH_STATS_LOGGER
-        if (gridData.cells[currentCellId % CHUNKS][currentCellId].edges.size() > maxEdges) {
-            maxEdges = gridData.cells[currentCellId % CHUNKS][currentCellId].edges.size();
+        if (graph.arcsOf(currentIndex).size() > maxEdges) {
+            maxEdges = graph.arcsOf(currentIndex).size();
         }
 #endif
 
-        for (const auto &[neighborCellId, edge, samples]: gridData.cells[currentCellId % CHUNKS][currentCellId].edges) {
-            if (visited[neighborCellId] == 1) continue;
-
-            uint64_t inEdges = gridData.cells[neighborCellId % CHUNKS][neighborCellId].inEdges.size();
-            uint64_t outEdges = gridData.cells[neighborCellId % CHUNKS][neighborCellId].edges.size();
-
-            uint64_t id = neighborCellId;
-            uint64_t dist = originCurrent + (edge / samples);
-
-//            if (oneToAll) {
-//                while (inEdges == 1 && outEdges == 1) {
-//#ifdef SEARCH_STATS_LOGGER
-//                    heuristicSkips++;
-//#endif
-//                    if (expandable[id] == 1) {
-//                        searchLogger.warn("Cell %llu expanded from base %llu", id, currentCellId);
-//                        searchLogger.warn("Type in %lu, out %lu", gridData.cells[currentCellId % CHUNKS][currentCellId].inEdges.size(),
-//                                          gridData.cells[currentCellId % CHUNKS][currentCellId].edges.size());
-//                    }
-//                    expandable[id] = expandable[id] + 1;
-//                    sum += dist;
-//
-//                    auto &[nextId, nextEdge, nextSamples] = gridData.cells[id % CHUNKS][id].edges.front();
-//                    inEdges = gridData.cells[nextId % CHUNKS][nextId].inEdges.size();
-//                    outEdges = gridData.cells[nextId % CHUNKS][nextId].edges.size();
-//
-//                    dist += (nextEdge / nextSamples);
-//                    id = nextId;
-//                }
-//            }
-
-            pq.push({dist, id});
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            if (ws.settled(neighborIndex)) continue;
+
+            uint32_t id = neighborIndex;
+            uint64_t dist = originCurrent + weight;
+            if (ws.reached(id) && ws.distances[id] <= dist) continue;
+
+            ws.reach(id, dist);
+            pq.push(dist, id);
         }
     }
 
 #ifdef SEARCH_STATS_LOGGER
     searchLogger.warn("Max sums: %lu Max edges: %lu Max PQ size: %lu", maxSums, maxEdges, maxPqSize);
-    searchLogger.warn("Heuristic skips: %lu", heuristicSkips);
-    searchLogger.warn("Expanded cells: %lu", expandable.size());
-    for (const auto &[id, count]: expandable) {
-        if (count > 1) {
-            searchLogger.warn("Cell %llu expanded %llu times", id, count);
-
-        }
-    }
 #endif
 #ifdef SEARCH_TIME_LOGGER
     auto stop = std::chrono::high_resolution_clock::now();
@@ -129,3 +110,288 @@ uint64_t dijkstra(GridData &gridData, uint64_t &originCellId, uint64_t &destinat
 #endif
     return sum;
 }
+
+template<typename Queue>
+uint64_t bidirectionalDijkstra(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex) {
+#ifdef SEARCH_ALGO_LOGGER
+    searchLogger.debug("--- Bidirectional Dijkstra from %u to %u ---", originIndex, destinationIndex);
+#endif
+    // Unknown cells keep the unidirectional semantics
+    if (originIndex == NO_CELL || destinationIndex == NO_CELL) {
+        return dijkstra<Queue>(graph, originIndex, destinationIndex, ONE_TO_ONE);
+    }
+    if (originIndex == destinationIndex) return 0;
+
+    static thread_local Queue forwardQueue;
+    static thread_local Queue backwardQueue;
+    SearchWorkspace &forward = searchWorkspace;
+    SearchWorkspace &backward = reverseWorkspace;
+    forward.prepare(graph.size());
+    backward.prepare(graph.size());
+    forwardQueue.prepare(graph.size());
+    backwardQueue.prepare(graph.size());
+
+    // Sum of settled forward distances, the answer when the destination turns out to be unreachable
+    uint64_t sum = 0;
+    uint64_t best = numeric_limits<uint64_t>::max();
+
+    forward.reach(originIndex, 0);
+    forwardQueue.push(0, originIndex);
+    backward.reach(destinationIndex, 0);
+    backwardQueue.push(0, destinationIndex);
+
+    while (true) {
+        while (!forwardQueue.empty() && forward.settled(forwardQueue.top().second)) forwardQueue.pop();
+        while (!backwardQueue.empty() && backward.settled(backwardQueue.top().second)) backwardQueue.pop();
+
+        // Everything reachable from the origin is settled
+        if (forwardQueue.empty()) break;
+
+        if (backwardQueue.empty()) {
+            if (best != numeric_limits<uint64_t>::max()) break;
+        } else if (forwardQueue.top().first + backwardQueue.top().first >= best) {
+            break;
+        }
+
+        // Expand the side with the smaller radius, the forward one only after the backward one ran dry
+        if (!backwardQueue.empty() && backwardQueue.top().first < forwardQueue.top().first) {
+            auto [currentDistance, currentIndex] = backwardQueue.top();
+            backwardQueue.pop();
+            backward.settle(currentIndex);
+
+            for (const auto &[neighborIndex, weight]: graph.reverseArcsOf(currentIndex)) {
+                if (backward.settled(neighborIndex)) continue;
+
+                uint64_t dist = currentDistance + weight;
+                if (forward.reached(neighborIndex) || forward.settled(neighborIndex)) {
+                    best = min(best, dist + forward.distances[neighborIndex]);
+                }
+                if (backward.reached(neighborIndex) && backward.distances[neighborIndex] <= dist) continue;
+                backward.reach(neighborIndex, dist);
+                backwardQueue.push(dist, neighborIndex);
+            }
+        } else {
+            auto [currentDistance, currentIndex] = forwardQueue.top();
+            forwardQueue.pop();
+            forward.settle(currentIndex);
+            sum += currentDistance;
+
+            for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+                if (forward.settled(neighborIndex)) continue;
+
+                uint64_t dist = currentDistance + weight;
+                if (backward.reached(neighborIndex) || backward.settled(neighborIndex)) {
+                    best = min(best, dist + backward.distances[neighborIndex]);
+                }
+                if (forward.reached(neighborIndex) && forward.distances[neighborIndex] <= dist) continue;
+                forward.reach(neighborIndex, dist);
+                forwardQueue.push(dist, neighborIndex);
+            }
+        }
+    }
+
+    return best != numeric_limits<uint64_t>::max() ? best : sum;
+}
+
+// A* directed by a consistent heuristic, the cost of the cell index towards the destination
+template<typename Queue, typename Heuristic>
+static uint64_t directedSearch(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex,
+                               Heuristic heuristic) {
+    static thread_local Queue pq;
+    SearchWorkspace &ws = searchWorkspace;
+    ws.prepare(graph.size());
+    pq.prepare(graph.size());
+<<<<<<< HEAD
+    const GraphPoint &destination = graph.point(destinationIndex);
+=======
+>>>>>>> e4b7306 ([user-021] Add an ALT landmark index for OneToOne search)
+
+    // The heuristic is consistent, settled distances are final and their sum matches Dijkstra when unreachable
+    uint64_t sum = 0;
+
+    ws.reach(originIndex, 0);
+    pq.push(heuristic(originIndex), originIndex);
+
+    while (!pq.empty()) {
+        uint32_t currentIndex = pq.top().second;
+        pq.pop();
+        if (ws.settled(currentIndex)) continue;
+        ws.settle(currentIndex);
+
+        uint64_t currentDistance = ws.distances[currentIndex];
+        if (currentIndex == destinationIndex) return currentDistance;
+        sum += currentDistance;
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            if (ws.settled(neighborIndex)) continue;
+
+            uint64_t dist = currentDistance + weight;
+            if (ws.reached(neighborIndex) && ws.distances[neighborIndex] <= dist) continue;
+
+            ws.reach(neighborIndex, dist);
+            pq.push(dist + heuristic(neighborIndex), neighborIndex);
+        }
+    }
+
+    return sum;
+}
+
+template<typename Queue>
+uint64_t aStar(const GridGraph &graph, uint32_t originIndex, uint32_t destinationIndex) {
+#ifdef SEARCH_ALGO_LOGGER
+    searchLogger.debug("--- A* from %u to %u ---", originIndex, destinationIndex);
+#endif
+    // Without a destination point there is nothing to direct the search to
+    if (originIndex == NO_CELL || destinationIndex == NO_CELL) {
+        return dijkstra<Queue>(graph, originIndex, destinationIndex, ONE_TO_ONE);
+    }
+
+    const GraphPoint &destination = graph.points[destinationIndex];
+    return directedSearch<Queue>(graph, originIndex, destinationIndex, [&](uint32_t index) {
+        return graph.heuristic(index, destination);
+    });
+}
+
+template<typename Queue>
+uint64_t landmarkAStar(const GridGraph &graph, const LandmarkBounds &bounds, uint32_t originIndex,
+                       uint32_t destinationIndex) {
+#ifdef SEARCH_ALGO_LOGGER
+    searchLogger.debug("--- ALT A* from %u to %u ---", originIndex, destinationIndex);
+#endif
+    if (originIndex == NO_CELL || destinationIndex == NO_CELL) {
+        return dijkstra<Queue>(graph, originIndex, destinationIndex, ONE_TO_ONE);
+    }
+
+    // Distances between the destination and the landmarks are shared by all cells of the search
+    uint32_t count = bounds.index->count;
+    uint64_t fromLandmark[LANDMARK_COUNT];
+    uint64_t toLandmark[LANDMARK_COUNT];
+    for (uint32_t landmark = 0; landmark < count; landmark++) {
+        fromLandmark[landmark] = bounds.forward(destinationIndex, landmark);
+        toLandmark[landmark] = bounds.backward(destinationIndex, landmark);
+    }
+
+    // Each bound is consistent on its own, so is their maximum with the geometric one
+    const GraphPoint &destination = graph.points[destinationIndex];
+    return directedSearch<Queue>(graph, originIndex, destinationIndex, [&](uint32_t index) {
+        uint64_t bound = graph.heuristic(index, destination);
+        for (uint32_t landmark = 0; landmark < count; landmark++) {
+            uint64_t from = bounds.forward(index, landmark);
+            if (fromLandmark[landmark] > from) bound = max(bound, fromLandmark[landmark] - from);
+            uint64_t to = bounds.backward(index, landmark);
+            if (to > toLandmark[landmark]) bound = max(bound, to - toLandmark[landmark]);
+        }
+        return bound;
+    });
+}
+
+template<typename Queue>
+uint64_t chainDijkstra(const GridGraph &graph, const ChainGraph &chainGraph, uint32_t originIndex) {
+#ifdef SEARCH_ALGO_LOGGER
+    searchLogger.debug("--- Chain Dijkstra from %u to all ---", originIndex);
+#endif
+    // Unknown origin has no outgoing edges
+    if (originIndex == NO_CELL) return 0;
+
+    static thread_local Queue pq;
+    SearchWorkspace &ws = searchWorkspace;
+    ws.prepare(chainGraph.size());
+    pq.prepare(chainGraph.size());
+
+    ChainOrigin origin = chainGraph.locate(graph, originIndex);
+    if (origin.junction == NO_CELL) return origin.sum;
+
+    uint64_t sum = origin.sum;
+    ws.reach(origin.junction, origin.distance);
+    pq.push(origin.distance, origin.junction);
+
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+
+        if (ws.settled(currentIndex)) continue;
+        ws.settle(currentIndex);
+
+        // Interior cells of the junction chains are settled together with the junction
+        sum += chainGraph.settledSum(currentIndex, currentDistance, origin);
+
+        for (uint32_t arc = chainGraph.offsets[currentIndex]; arc < chainGraph.offsets[currentIndex + 1]; arc++) {
+            const auto &[neighborIndex, weight] = chainGraph.arcs[arc];
+            if (ws.settled(neighborIndex)) continue;
+
+            uint64_t dist = currentDistance + weight;
+            if (ws.reached(neighborIndex) && ws.distances[neighborIndex] <= dist) continue;
+
+            ws.reach(neighborIndex, dist);
+            pq.push(dist, neighborIndex);
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * Single forward search settling several targets, stopped once all of them are settled. Unreachable
+ * targets keep UNREACHED, the returned sum of all settled distances is what OneToOne answers for them,
+ * it is complete only for an exhaustive search or when some target stayed unreachable.
+ */
+template<typename Queue>
+uint64_t dijkstraToMany(const GridGraph &graph, uint32_t originIndex,
+                        const ankerl::unordered_dense::map<uint32_t, uint32_t> &targets, bool exhaustive,
+                        vector<uint64_t> &targetDistances) {
+    targetDistances.assign(targets.size(), UNREACHED);
+    // Unknown origin has no outgoing edges
+    if (originIndex == NO_CELL) return 0;
+
+    static thread_local Queue pq;
+    SearchWorkspace &ws = searchWorkspace;
+    ws.prepare(graph.size());
+    pq.prepare(graph.size());
+
+    uint64_t sum = 0;
+    size_t remaining = targets.size();
+    ws.reach(originIndex, 0);
+    pq.push(0, originIndex);
+
+    while (!pq.empty()) {
+        auto [currentDistance, currentIndex] = pq.top();
+        pq.pop();
+
+        if (ws.settled(currentIndex)) continue;
+        ws.settle(currentIndex);
+        sum += currentDistance;
+
+        auto target = targets.find(currentIndex);
+        if (target != targets.end()) {
+            targetDistances[target->second] = currentDistance;
+            if (--remaining == 0 && !exhaustive) break;
+        }
+
+        for (const auto &[neighborIndex, weight]: graph.arcsOf(currentIndex)) {
+            if (ws.settled(neighborIndex)) continue;
+
+            uint64_t dist = currentDistance + weight;
+            if (ws.reached(neighborIndex) && ws.distances[neighborIndex] <= dist) continue;
+
+            ws.reach(neighborIndex, dist);
+            pq.push(dist, neighborIndex);
+        }
+    }
+
+    return sum;
+}
+
+// Instantiations ---------------------------------------------------------------------------------
+#define INSTANTIATE_SEARCHES(Queue)                                                                         \
+    template uint64_t dijkstra<Queue>(const GridGraph &, uint32_t, uint32_t, bool);                         \
+    template uint64_t bidirectionalDijkstra<Queue>(const GridGraph &, uint32_t, uint32_t);                  \
+    template uint64_t aStar<Queue>(const GridGraph &, uint32_t, uint32_t);                                  \
+    template uint64_t landmarkAStar<Queue>(const GridGraph &, const LandmarkBounds &, uint32_t, uint32_t);  \
+    template uint64_t chainDijkstra<Queue>(const GridGraph &, const ChainGraph &, uint32_t);                \
+    template uint64_t dijkstraToMany<Queue>(const GridGraph &, uint32_t,                                    \
+                                            const ankerl::unordered_dense::map<uint32_t, uint32_t> &, bool, \
+                                            vector<uint64_t> &);
+
+INSTANTIATE_SEARCHES(BinaryHeapQueue)
+INSTANTIATE_SEARCHES(RadixHeapQueue)
+INSTANTIATE_SEARCHES(IndexedDaryHeapQueue<4>)
@@ -0,0 +1,280 @@
+#include "GridStore.hh"
+
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Global variables -------------------------------------------------------------------------------
+//#define STORE_LOGGER
+PrefixedLogger storeLogger = PrefixedLogger("[STORE     ]", true);
+
+WriteAheadLog writeAheadLog;
+
+// Class definition -------------------------------------------------------------------------------
+// Makes a created, renamed or removed entry of the directory of the path durable
+static bool syncDirectory(const string &path) {
+    size_t slash = path.rfind('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+static bool writeAll(int fd, const char *data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = write(fd, data + written, size - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result < 0) return false;
+        written += result;
+    }
+    return true;
+}
+
+string logPath(const string &snapshotPath, uint64_t generation) {
+    return snapshotPath + ".wal." + to_string(generation);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (fd >= 0) close(fd);
+}
+
+void WriteAheadLog::openGeneration() {
+#ifdef ENABLE_WRITE_AHEAD_LOG
+    fd = open(logPath(path, generation).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    // Recovery stops at the first missing generation, so the new one must not get lost
+    if (fd < 0 || !syncDirectory(path)) {
+        storeLogger.error("Cannot create the write-ahead log %s", logPath(path, generation).c_str());
+    }
+#endif
+}
+
+void WriteAheadLog::start(const string &snapshotPath, uint64_t oldestGeneration, uint64_t nextGeneration) {
+    lock_guard<mutex> guard(lock);
+    path = snapshotPath;
+    oldest = oldestGeneration;
+    generation = nextGeneration;
+    synced = chrono::steady_clock::now();
+    openGeneration();
+}
+
+void WriteAheadLog::append(const esw::Request &request) {
+    lock_guard<mutex> guard(lock);
+    if (fd < 0) return;
+    uint32_t size = request.ByteSizeLong();
+    size_t offset = pending.size();
+    pending.resize(offset + sizeof(size) + size);
+    uint32_t networkSize = htonl(size);
+    memcpy(pending.data() + offset, &networkSize, sizeof(networkSize));
+    request.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t *>(pending.data() + offset + sizeof(size)));
+}
+
+bool WriteAheadLog::flush() {
+    if (fd < 0 || pending.empty()) return true;
+    bool durable = writeAll(fd, pending.data(), pending.size()) && fdatasync(fd) == 0;
+    pending.clear();
+    return durable;
+}
+
+bool WriteAheadLog::sync() {
+    lock_guard<mutex> guard(lock);
+    synced = chrono::steady_clock::now();
+    return flush();
+}
+
+uint64_t WriteAheadLog::rotate() {
+    lock_guard<mutex> guard(lock);
+    // Records of the closed generation are durable before a snapshot can replace it
+    if (!flush()) storeLogger.error("Cannot sync the write-ahead log %s", logPath(path, generation).c_str());
+    if (fd >= 0) close(fd);
+    fd = -1;
+    generation++;
+    openGeneration();
+    return generation;
+}
+
+void WriteAheadLog::removeBefore(uint64_t generation) {
+    lock_guard<mutex> guard(lock);
+    for (; oldest < generation; oldest++) {
+        unlink(logPath(path, oldest).c_str());
+    }
+}
+
+bool replayLog(GridData &gridData, GridStats &gridStats, const string &path, uint64_t &records) {
+    ifstream input(path, ios::binary);
+    if (!input) return false;
+
+    // A crash leaves at most the last record incomplete, it was never acknowledged
+    vector<char> buffer;
+    uint32_t size;
+    while (input.read(reinterpret_cast<char *>(&size), sizeof(size))) {
+        size = ntohl(size);
+        buffer.resize(size);
+        if (!input.read(buffer.data(), size)) break;
+
+        esw::Request request;
+        if (!request.ParseFromArray(buffer.data(), size)) break;
+        if (request.has_walk()) processWalk(gridData, gridStats, request.walk());
+        if (request.has_reset()) processReset(gridData, gridStats);
+        records++;
+    }
+    return true;
+}
+
+vector<char> captureSnapshot(GridData &gridData, uint64_t logGeneration) {
+    uint64_t cellCount = gridData.cellIds.size();
+    uint64_t edgeCount = 0;
+    vector<const Cell *> cells;
+    cells.reserve(cellCount);
+    for (const auto &cellId: gridData.cellIds) {
+        cells.push_back(&gridData.cells[cellId % CHUNKS].find(cellId)->second);
+        edgeCount += cells.back()->edges.size();
+    }
+
+    SnapshotLayout layout(cellCount, edgeCount);
+    vector<char> image(layout.size);
+    auto *header = reinterpret_cast<SnapshotHeader *>(image.data());
+    *header = {SNAPSHOT_MAGIC, SNAPSHOT_FORMAT, 0, gridData.version, logGeneration, cellCount, edgeCount};
+
+    auto *cellRecords = reinterpret_cast<SnapshotCell *>(image.data() + layout.cells);
+    auto *edgeOffsets = reinterpret_cast<uint64_t *>(image.data() + layout.edgeOffsets);
+    auto *edges = reinterpret_cast<Edge *>(image.data() + layout.edges);
+    auto *inEdgeOffsets = reinterpret_cast<uint64_t *>(image.data() + layout.inEdgeOffsets);
+    auto *inEdges = reinterpret_cast<Edge *>(image.data() + layout.inEdges);
+    edgeOffsets[0] = 0;
+    inEdgeOffsets[0] = 0;
+    for (uint64_t index = 0; index < cellCount; index++) {
+        const Cell &cell = *cells[index];
+        cellRecords[index] = {gridData.cellIds[index], cell.pointX, cell.pointY};
+        memcpy(edges + edgeOffsets[index], cell.edges.data(), cell.edges.size() * sizeof(Edge));
+        edgeOffsets[index + 1] = edgeOffsets[index] + cell.edges.size();
+        memcpy(inEdges + inEdgeOffsets[index], cell.inEdges.data(), cell.inEdges.size() * sizeof(Edge));
+        inEdgeOffsets[index + 1] = inEdgeOffsets[index] + cell.inEdges.size();
+    }
+    return image;
+}
+
+bool writeSnapshot(const vector<char> &image, const string &path) {
+    string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    // The data has to be durable before the rename makes it the snapshot
+    bool complete = writeAll(fd, image.data(), image.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!complete || rename(temporary.c_str(), path.c_str()) != 0) {
+        unlink(temporary.c_str());
+        return false;
+    }
+    // The logs the snapshot contains are removed only once the rename cannot be lost
+    if (!syncDirectory(path)) return false;
+#ifdef STORE_LOGGER
+    storeLogger.info("Snapshot of %lu bytes written to %s", image.size(), path.c_str());
+#endif
+    return true;
+}
+
+// Checks the sections of an image before anything indexes by them
+static bool validImage(const char *image, size_t size) {
+    if (size < sizeof(SnapshotHeader)) return false;
+    const auto *header = reinterpret_cast<const SnapshotHeader *>(image);
+    if (header->magic != SNAPSHOT_MAGIC || header->format != SNAPSHOT_FORMAT) return false;
+    // Bounded counts keep the layout from overflowing
+    if (header->cellCount >= NO_CELL || header->cellCount > size / sizeof(SnapshotCell) ||
+        header->edgeCount > size / sizeof(Edge)) return false;
+
+    SnapshotLayout layout(header->cellCount, header->edgeCount);
+    if (layout.size != size) return false;
+
+    for (size_t section: {layout.edgeOffsets, layout.inEdgeOffsets}) {
+        const auto *offsets = reinterpret_cast<const uint64_t *>(image + section);
+        const auto *edges = reinterpret_cast<const Edge *>(image + section + (header->cellCount + 1) * sizeof(uint64_t));
+        if (offsets[0] != 0 || offsets[header->cellCount] != header->edgeCount) return false;
+        for (uint64_t index = 0; index < header->cellCount; index++) {
+            if (offsets[index] > offsets[index + 1]) return false;
+        }
+        for (uint64_t edge = 0; edge < header->edgeCount; edge++) {
+            if (edges[edge].index >= header->cellCount || edges[edge].samples == 0) return false;
+        }
+    }
+    return true;
+}
+
+bool loadSnapshot(GridData &gridData, GridStats &gridStats, const string &path, uint64_t &logGeneration) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = status.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    const char *image = static_cast<const char *>(mapping);
+    if (!validImage(image, size)) {
+        munmap(mapping, size);
+#ifdef STORE_LOGGER
+        storeLogger.error("Snapshot %s is not of format %d", path.c_str(), SNAPSHOT_FORMAT);
+#endif
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const SnapshotHeader *>(image);
+    SnapshotLayout layout(header->cellCount, header->edgeCount);
+    const auto *cellRecords = reinterpret_cast<const SnapshotCell *>(image + layout.cells);
+    const auto *edgeOffsets = reinterpret_cast<const uint64_t *>(image + layout.edgeOffsets);
+    const auto *edges = reinterpret_cast<const Edge *>(image + layout.edges);
+    const auto *inEdgeOffsets = reinterpret_cast<const uint64_t *>(image + layout.inEdgeOffsets);
+    const auto *inEdges = reinterpret_cast<const Edge *>(image + layout.inEdges);
+
+    gridData.resetGrid(gridStats);
+    array<size_t, CHUNKS> chunkCells = {};
+    for (uint64_t index = 0; index < header->cellCount; index++) {
+        chunkCells[cellRecords[index].id % CHUNKS]++;
+    }
+    for (int i = 0; i < CHUNKS; i++) {
+        gridData.cells[i].reserve(chunkCells[i]);
+        gridStats.quad[i] = chunkCells[i];
+    }
+
+    // Edge lists keep the order they had, so the searches settle ties like before the restart
+    gridData.cellIds.resize(header->cellCount);
+    for (uint32_t index = 0; index < header->cellCount; index++) {
+        const SnapshotCell &record = cellRecords[index];
+        uint32_t chunk = record.id % CHUNKS;
+        Cell cell = {index, record.pointX, record.pointY, {}, {}};
+        cell.edges.reserve(edgeOffsets[index + 1] - edgeOffsets[index]);
+        for (uint64_t edge = edgeOffsets[index]; edge < edgeOffsets[index + 1]; edge++) {
+            gridData.edgeIndex[chunk].append(cell.edges, index, edges[edge]);
+        }
+        cell.inEdges.reserve(inEdgeOffsets[index + 1] - inEdgeOffsets[index]);
+        for (uint64_t edge = inEdgeOffsets[index]; edge < inEdgeOffsets[index + 1]; edge++) {
+            gridData.inEdgeIndex[chunk].append(cell.inEdges, index, inEdges[edge]);
+        }
+#ifdef ENABLE_CELL_TILE_INDEX
+        gridData.cellIndex.insert(record.id, index, cell.point());
+#endif
+        gridData.cellIds[index] = record.id;
+        gridData.cells[chunk].emplace(record.id, std::move(cell));
+    }
+    gridStats.edges_count = header->edgeCount;
+    logGeneration = header->logGeneration;
+
+    // Past both the loaded version and the published snapshot, so the next publish rebuilds the graph
+    gridData.version = max<uint64_t>(gridData.version + 1, header->version);
+    gridData.edgeChangesSince = gridData.version;
+#ifdef STORE_LOGGER
+    storeLogger.info("Snapshot of %lu cells and %lu edges loaded from %s at version %lu", header->cellCount,
+                     header->edgeCount, path.c_str(), header->version);
+#endif
+    munmap(mapping, size);
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef GRID_STORE_HH
+#define GRID_STORE_HH
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+
+#include "GridModel.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// "GRIDSNAP" read as a little-endian word
+#define SNAPSHOT_MAGIC  0x50414e5344495247ull
+#define SNAPSHOT_FORMAT 2
+
+// Pause of the background writer between two snapshots of a changed grid
+#ifndef SNAPSHOT_INTERVAL_MS
+#define SNAPSHOT_INTERVAL_MS 10000
+#endif
+
+// Least time between two syncs of the write-ahead log, 0 syncs once per applied batch
+#ifndef WAL_SYNC_INTERVAL_US
+#define WAL_SYNC_INTERVAL_US 0
+#endif
+
+#if defined(ENABLE_WRITE_AHEAD_LOG) && !defined(ENABLE_BATCHED_INGESTION)
+#error "The write-ahead log is written by the batched ingestion writer"
+#endif
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+/**
+ * Header of the on-disk snapshot of the grid. All sections after it are arrays of fixed-size records in
+ * the layout the grid keeps in memory, so a mapped file is copied into the grid without parsing:
+ *   header | cells | edge offsets | edges | in-edge offsets | in-edges
+ * Cells come in index order, the offsets are CSR offsets with cellCount + 1 entries into the edge
+ * arrays. A file of another magic or format is rejected and the grid starts empty.
+ */
+struct SnapshotHeader {
+    uint64_t magic;
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t version;       // grid version the snapshot was taken at
+    uint64_t logGeneration; // first write-ahead log not contained in the snapshot
+    uint64_t cellCount;
+    uint64_t edgeCount;     // per direction, every edge is kept by both of its cells
+};
+
+struct SnapshotCell {
+    uint64_t id;
+    int32_t pointX;
+    int32_t pointY;
+};
+
+static_assert(sizeof(SnapshotHeader) == 48 && sizeof(SnapshotCell) == 16 && sizeof(Edge) == 16,
+              "Changing the records changes the snapshot format");
+
+// Byte offsets of the sections of a snapshot with the given counts
+struct SnapshotLayout {
+    size_t cells;
+    size_t edgeOffsets;
+    size_t edges;
+    size_t inEdgeOffsets;
+    size_t inEdges;
+    size_t size;
+
+    SnapshotLayout(uint64_t cellCount, uint64_t edgeCount) {
+        cells = sizeof(SnapshotHeader);
+        edgeOffsets = cells + cellCount * sizeof(SnapshotCell);
+        edges = edgeOffsets + (cellCount + 1) * sizeof(uint64_t);
+        inEdgeOffsets = edges + edgeCount * sizeof(Edge);
+        inEdges = inEdgeOffsets + (cellCount + 1) * sizeof(uint64_t);
+        size = inEdges + edgeCount * sizeof(Edge);
+    }
+};
+
+/**
+ * Append-only log of the walks and resets applied since the last snapshot, in the length-prefixed format
+ * of the request streams. Records are buffered by the writer as it applies them and made durable by one
+ * write and one fdatasync per group, the writer acknowledges the group only after that. Every snapshot
+ * starts a new generation of the log, the generations it contains are removed once it is on disk.
+ */
+class WriteAheadLog {
+private:
+    mutex lock;
+    string path;                // snapshot the generations belong to
+    uint64_t oldest;            // first generation still on disk
+    uint64_t generation;        // generation appended to
+    int fd;
+    vector<char> pending;       // records appended since the last sync
+    chrono::steady_clock::time_point synced;
+
+    bool flush();
+
+    void openGeneration();
+public:
+    WriteAheadLog() : oldest(0), generation(0), fd(-1) {}
+
+    ~WriteAheadLog();
+
+    // Continues after the recovered generations, oldest is the first one the loaded snapshot misses
+    void start(const string &snapshotPath, uint64_t oldestGeneration, uint64_t nextGeneration);
+
+    void append(const esw::Request &request);
+
+    // Makes all appended records durable, false when they may not be
+    bool sync();
+
+    chrono::steady_clock::time_point lastSync() const {
+        return synced;
+    }
+
+    // Closes the generation with its records durable and starts the next one, returns its number
+    uint64_t rotate();
+
+    // Removes the generations a written snapshot contains
+    void removeBefore(uint64_t generation);
+};
+
+extern WriteAheadLog writeAheadLog;
+
+string logPath(const string &snapshotPath, uint64_t generation);
+
+// Applies the walks and resets of a log up to its first incomplete record, false when it is missing
+bool replayLog(GridData &gridData, GridStats &gridStats, const string &path, uint64_t &records);
+
+// Serializes the grid into a snapshot image, the caller excludes walks meanwhile
+vector<char> captureSnapshot(GridData &gridData, uint64_t logGeneration);
+
+// Writes the image beside the path and renames it over, a crash leaves the previous snapshot intact
+bool writeSnapshot(const vector<char> &image, const string &path);
+
+// Replaces the grid by the snapshot mapped from the path, false when it is missing or invalid
+bool loadSnapshot(GridData &gridData, GridStats &gridStats, const string &path, uint64_t &logGeneration);
+
+// Snapshots the grid to the path whenever it changed, runs on a pool thread forever
+void runSnapshots(GridData &gridData, const string &path);
+
+#endif //GRID_STORE_HH
@@ -0,0 +1,130 @@
+#ifndef SMALL_VECTOR_HH
+#define SMALL_VECTOR_HH
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+/**
+ * Vector keeping up to N elements inline and moving to the heap beyond them. Elements have to be
+ * trivially copyable, they are moved around with memcpy. Only appending is supported.
+ */
+template<typename T, uint32_t N>
+class SmallVector {
+    static_assert(N > 0, "Inline capacity has to hold an element");
+    static_assert(is_trivially_copyable_v<T>, "Elements are moved around with memcpy");
+private:
+    union {
+        T local[N];
+        T *heap;
+    };
+    uint32_t count;
+    uint32_t capacity;      // N while the elements are inline
+
+    bool isInline() const {
+        return capacity == N;
+    }
+
+    void release() {
+        if (!isInline()) delete[] heap;
+        count = 0;
+        capacity = N;
+    }
+public:
+    SmallVector() : count(0), capacity(N) {}
+
+    SmallVector(const SmallVector &other) : count(0), capacity(N) {
+        reserve(other.count);
+        memcpy(data(), other.data(), other.count * sizeof(T));
+        count = other.count;
+    }
+
+    SmallVector(SmallVector &&other) noexcept : count(other.count), capacity(other.capacity) {
+        if (other.isInline()) {
+            memcpy(local, other.local, count * sizeof(T));
+        } else {
+            heap = other.heap;
+            other.count = 0;
+            other.capacity = N;
+        }
+    }
+
+    ~SmallVector() {
+        release();
+    }
+
+    SmallVector &operator=(const SmallVector &other) {
+        if (this != &other) {
+            count = 0;
+            reserve(other.count);
+            memcpy(data(), other.data(), other.count * sizeof(T));
+            count = other.count;
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            release();
+            new(this) SmallVector(std::move(other));
+        }
+        return *this;
+    }
+
+    void reserve(uint32_t size) {
+        if (size <= capacity) return;
+        T *elements = new T[size];
+        memcpy(elements, data(), count * sizeof(T));
+        if (!isInline()) delete[] heap;
+        heap = elements;
+        capacity = size;
+    }
+
+    void push_back(const T &element) {
+        if (count == capacity) reserve(capacity * 2);
+        data()[count++] = element;
+    }
+
+    T *data() {
+        return isInline() ? local : heap;
+    }
+
+    const T *data() const {
+        return isInline() ? local : heap;
+    }
+
+    uint32_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Bytes allocated outside of the vector itself
+    size_t heapBytes() const {
+        return isInline() ? 0 : capacity * sizeof(T);
+    }
+
+    T *begin() {
+        return data();
+    }
+
+    T *end() {
+        return data() + count;
+    }
+
+    const T *begin() const {
+        return data();
+    }
+
+    const T *end() const {
+        return data() + count;
+    }
+};
+
+#endif //SMALL_VECTOR_HH
@@ -11,6 +11,7 @@
 
 #include "Logger.hh"
 #include "GridModel.hh"
+#include "GridStore.hh"
 #include "ThreadPool.hh"
 
 using namespace std;
@@ -18,7 +19,11 @@ using namespace std;
 // Global variables -------------------------------------------------------------------------------
 PrefixedLogger logger = PrefixedLogger("[SERVER APP]", true);
 
+#ifdef ENABLE_CONCURRENT_INGESTION
+ThreadPool resourcePool(INGESTION_THREADS);
+#else
 ThreadPool resourcePool(1);
+#endif
 ThreadPool resourcePool1(31);
 GridData gridData = GridData();
 GridStats gridStats = GridStats();
@@ -26,8 +31,8 @@ GridStats gridStats = GridStats();
 // Main function -----------------------------------------------------------------------------------
 int main(int argc, char *argv[]) {
     unsigned short int port;
-    if (argc != 2) {
-        cout << "[ERROR] One argument required <port>" << endl;
+    if (argc < 2) {
+        cout << "[ERROR] Arguments required <port> [snapshot]" << endl;
         port = 4444;
     } else {
         port = atoi(argv[1]);
@@ -43,6 +48,31 @@ int main(int argc, char *argv[]) {
     uint64_t numCores = sysconf(_SC_NPROCESSORS_ONLN);
     logger.info("Available cores: " + to_string(numCores));
 
+#ifdef ENABLE_BATCHED_INGESTION
+    // The walk pool thread becomes the single writer of the grid
+    resourcePool.run([]() { runIngestion(gridData, gridStats); }, -1);
+#endif
+
+    // The grid of the last run is mapped back and its logs replayed before any client connects
+    if (argc > 2) {
+        string snapshotPath = argv[2];
+        auto start = chrono::high_resolution_clock::now();
+        uint64_t firstGeneration = 0;
+        if (!loadSnapshot(gridData, gridStats, snapshotPath, firstGeneration)) {
+            logger.warn("No valid snapshot in %s, starting with an empty grid", snapshotPath.c_str());
+        }
+        uint64_t generation = firstGeneration;
+        uint64_t records = 0;
+        while (replayLog(gridData, gridStats, logPath(snapshotPath, generation), records)) generation++;
+        gridData.publishSnapshot();
+        auto stop = chrono::high_resolution_clock::now();
+        logger.info("Recovered %lu cells and %lu logged requests in %lu ms", gridData.cellIds.size(), records,
+                    chrono::duration_cast<chrono::milliseconds>(stop - start).count());
+
+        writeAheadLog.start(snapshotPath, firstGeneration, generation);
+        resourcePool1.run([snapshotPath]() { runSnapshots(gridData, snapshotPath); }, -1);
+    }
+
     // Epoll
     EpollInstance epollInstance;
 
@@ -88,6 +88,20 @@ struct ResetDefaultTypeInternal {
   };
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ResetDefaultTypeInternal _Reset_default_instance_;
+PROTOBUF_CONSTEXPR ManyToMany::ManyToMany(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.origins_)*/{}
+  , /*decltype(_impl_.destinations_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct ManyToManyDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR ManyToManyDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~ManyToManyDefaultTypeInternal() {}
+  union {
+    ManyToMany _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ManyToManyDefaultTypeInternal _ManyToMany_default_instance_;
 PROTOBUF_CONSTEXPR Location::Location(
     ::_pbi::ConstantInitialized): _impl_{
     /*decltype(_impl_.x_)*/0
@@ -104,7 +118,9 @@ struct LocationDefaultTypeInternal {
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 LocationDefaultTypeInternal _Location_default_instance_;
 PROTOBUF_CONSTEXPR Response::Response(
     ::_pbi::ConstantInitialized): _impl_{
-    /*decltype(_impl_.errmsg_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+    /*decltype(_impl_.distances_)*/{}
+  , /*decltype(_impl_._distances_cached_byte_size_)*/{0}
+  , /*decltype(_impl_.errmsg_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
   , /*decltype(_impl_.shortest_path_length_)*/uint64_t{0u}
   , /*decltype(_impl_.total_length_)*/uint64_t{0u}
   , /*decltype(_impl_.status_)*/0
@@ -119,7 +135,7 @@ struct ResponseDefaultTypeInternal {
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ResponseDefaultTypeInternal _Response_default_instance_;
 }  // namespace esw
-static ::_pb::Metadata file_level_metadata_scheme_2eproto[7];
+static ::_pb::Metadata file_level_metadata_scheme_2eproto[8];
 static const ::_pb::EnumDescriptor* file_level_enum_descriptors_scheme_2eproto[1];
 static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_scheme_2eproto = nullptr;
 
@@ -134,6 +150,7 @@ const uint32_t TableStruct_scheme_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(p
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
+  ::_pbi::kInvalidFieldOffsetTag,
   PROTOBUF_FIELD_OFFSET(::esw::Request, _impl_.msg_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::esw::Walk, _internal_metadata_),
@@ -165,6 +182,14 @@ const uint32_t TableStruct_scheme_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(p
   ~0u,  // no _weak_field_map_
   ~0u,  // no _inlined_string_donated_
   ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::esw::ManyToMany, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::esw::ManyToMany, _impl_.origins_),
+  PROTOBUF_FIELD_OFFSET(::esw::ManyToMany, _impl_.destinations_),
+  ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::esw::Location, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
@@ -182,15 +207,17 @@ const uint32_t TableStruct_scheme_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(p
   PROTOBUF_FIELD_OFFSET(::esw::Response, _impl_.errmsg_),
   PROTOBUF_FIELD_OFFSET(::esw::Response, _impl_.shortest_path_length_),
   PROTOBUF_FIELD_OFFSET(::esw::Response, _impl_.total_length_),
+  PROTOBUF_FIELD_OFFSET(::esw::Response, _impl_.distances_),
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, -1, sizeof(::esw::Request)},
-  { 11, -1, -1, sizeof(::esw::Walk)},
-  { 19, -1, -1, sizeof(::esw::OneToOne)},
-  { 27, -1, -1, sizeof(::esw::OneToAll)},
-  { 34, -1, -1, sizeof(::esw::Reset)},
-  { 40, -1, -1, sizeof(::esw::Location)},
-  { 48, -1, -1, sizeof(::esw::Response)},
+  { 12, -1, -1, sizeof(::esw::Walk)},
+  { 20, -1, -1, sizeof(::esw::OneToOne)},
+  { 28, -1, -1, sizeof(::esw::OneToAll)},
+  { 35, -1, -1, sizeof(::esw::Reset)},
+  { 41, -1, -1, sizeof(::esw::ManyToMany)},
+  { 49, -1, -1, sizeof(::esw::Location)},
+  { 57, -1, -1, sizeof(::esw::Response)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -199,31 +226,36 @@ static const ::_pb::Message* const file_default_instances[] = {
   &::esw::_OneToOne_default_instance_._instance,
   &::esw::_OneToAll_default_instance_._instance,
   &::esw::_Reset_default_instance_._instance,
+  &::esw::_ManyToMany_default_instance_._instance,
   &::esw::_Location_default_instance_._instance,
   &::esw::_Response_default_instance_._instance,
 };
 
 const char descriptor_table_protodef_scheme_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
-  "\n\014scheme.proto\022\003esw\"\216\001\n\007Request\022\031\n\004walk\030"
+  "\n\014scheme.proto\022\003esw\"\265\001\n\007Request\022\031\n\004walk\030"
   "\001 \001(\0132\t.esw.WalkH\000\022!\n\010oneToOne\030\002 \001(\0132\r.e"
   "sw.OneToOneH\000\022!\n\010oneToAll\030\003 \001(\0132\r.esw.On"
-  "eToAllH\000\022\033\n\005reset\030\004 \001(\0132\n.esw.ResetH\000B\005\n"
-  "\003msg\"9\n\004Walk\022 \n\tlocations\030\001 \003(\0132\r.esw.Lo"
-  "cation\022\017\n\007lengths\030\002 \003(\r\"M\n\010OneToOne\022\035\n\006o"
-  "rigin\030\001 \001(\0132\r.esw.Location\022\"\n\013destinatio"
-  "n\030\002 \001(\0132\r.esw.Location\")\n\010OneToAll\022\035\n\006or"
-  "igin\030\001 \001(\0132\r.esw.Location\"\007\n\005Reset\" \n\010Lo"
-  "cation\022\t\n\001x\030\001 \001(\005\022\t\n\001y\030\002 \001(\005\"\221\001\n\010Respons"
-  "e\022$\n\006status\030\001 \001(\0162\024.esw.Response.Status\022"
-  "\016\n\006errMsg\030\002 \001(\t\022\034\n\024shortest_path_length\030"
-  "\003 \001(\004\022\024\n\014total_length\030\004 \001(\004\"\033\n\006Status\022\006\n"
-  "\002OK\020\000\022\t\n\005ERROR\020\001b\006proto3"
+  "eToAllH\000\022\033\n\005reset\030\004 \001(\0132\n.esw.ResetH\000\022%\n"
+  "\nmanyToMany\030\005 \001(\0132\017.esw.ManyToManyH\000B\005\n\003"
+  "msg\"9\n\004Walk\022 \n\tlocations\030\001 \003(\0132\r.esw.Loc"
+  "ation\022\017\n\007lengths\030\002 \003(\r\"M\n\010OneToOne\022\035\n\006or"
+  "igin\030\001 \001(\0132\r.esw.Location\022\"\n\013destination"
+  "\030\002 \001(\0132\r.esw.Location\")\n\010OneToAll\022\035\n\006ori"
+  "gin\030\001 \001(\0132\r.esw.Location\"\007\n\005Reset\"Q\n\nMan"
+  "yToMany\022\036\n\007origins\030\001 \003(\0132\r.esw.Location\022"
+  "#\n\014destinations\030\002 \003(\0132\r.esw.Location\" \n\010"
+  "Location\022\t\n\001x\030\001 \001(\005\022\t\n\001y\030\002 \001(\005\"\244\001\n\010Respo"
+  "nse\022$\n\006status\030\001 \001(\0162\024.esw.Response.Statu"
+  "s\022\016\n\006errMsg\030\002 \001(\t\022\034\n\024shortest_path_lengt"
+  "h\030\003 \001(\004\022\024\n\014total_length\030\004 \001(\004\022\021\n\tdistanc"
+  "es\030\005 \003(\004\"\033\n\006Status\022\006\n\002OK\020\000\022\t\n\005ERROR\020\001b\006p"
+  "roto3"
   ;
 static ::_pbi::once_flag descriptor_table_scheme_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_scheme_2eproto = {
-    false, false, 544, descriptor_table_protodef_scheme_2eproto,
+    false, false, 685, descriptor_table_protodef_scheme_2eproto,
     "scheme.proto",
-    &descriptor_table_scheme_2eproto_once, nullptr, 0, 7,
+    &descriptor_table_scheme_2eproto_once, nullptr, 0, 8,
     schemas, file_default_instances, TableStruct_scheme_2eproto::offsets,
     file_level_metadata_scheme_2eproto, file_level_enum_descriptors_scheme_2eproto,
     file_level_service_descriptors_scheme_2eproto,
@@ -265,6 +297,7 @@ class Request::_Internal {
   static const ::esw::OneToOne& onetoone(const Request* msg);
   static const ::esw::OneToAll& onetoall(const Request* msg);
   static const ::esw::Reset& reset(const Request* msg);
+  static const ::esw::ManyToMany& manytomany(const Request* msg);
 };
 
 const ::esw::Walk&
@@ -283,6 +316,10 @@ const ::esw::Reset&
 Request::_Internal::reset(const Request* msg) {
   return *msg->_impl_.msg_.reset_;
 }
+const ::esw::ManyToMany&
+Request::_Internal::manytomany(const Request* msg) {
+  return *msg->_impl_.msg_.manytomany_;
+}
 void Request::set_allocated_walk(::esw::Walk* walk) {
   ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
   clear_msg();
@@ -343,6 +380,21 @@ void Request::set_allocated_reset(::esw::Reset* reset) {
   }
   // @@protoc_insertion_point(field_set_allocated:esw.Request.reset)
 }
+void Request::set_allocated_manytomany(::esw::ManyToMany* manytomany) {
+  ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
+  clear_msg();
+  if (manytomany) {
+    ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
+      ::PROTOBUF_NAMESPACE_ID::Arena::InternalGetOwningArena(manytomany);
+    if (message_arena != submessage_arena) {
+      manytomany = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
+          message_arena, manytomany, submessage_arena);
+    }
+    set_has_manytomany();
+    _impl_.msg_.manytomany_ = manytomany;
+  }
+  // @@protoc_insertion_point(field_set_allocated:esw.Request.manyToMany)
+}
 Request::Request(::PROTOBUF_NAMESPACE_ID::Arena* arena,
                          bool is_message_owned)
   : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
@@ -380,6 +432,11 @@ Request::Request(const Request& from)
           from._internal_reset());
       break;
     }
+    case kManyToMany: {
+      _this->_internal_mutable_manytomany()->::esw::ManyToMany::MergeFrom(
+          from._internal_manytomany());
+      break;
+    }
     case MSG_NOT_SET: {
       break;
     }
@@ -446,6 +503,12 @@ void Request::clear_msg() {
       }
       break;
     }
+    case kManyToMany: {
+      if (GetArenaForAllocation() == nullptr) {
+        delete _impl_.msg_.manytomany_;
+      }
+      break;
+    }
     case MSG_NOT_SET: {
       break;
     }
@@ -502,6 +565,14 @@ const char* Request::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx)
         } else
           goto handle_unusual;
         continue;
+      // .esw.ManyToMany manyToMany = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 42)) {
+          ptr = ctx->ParseMessage(_internal_mutable_manytomany(), ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -559,6 +630,13 @@ uint8_t* Request::_InternalSerialize(
         _Internal::reset(this).GetCachedSize(), target, stream);
   }
 
+  // .esw.ManyToMany manyToMany = 5;
+  if (_internal_has_manytomany()) {
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+      InternalWriteMessage(5, _Internal::manytomany(this),
+        _Internal::manytomany(this).GetCachedSize(), target, stream);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -604,6 +682,13 @@ size_t Request::ByteSizeLong() const {
           *_impl_.msg_.reset_);
       break;
     }
+    // .esw.ManyToMany manyToMany = 5;
+    case kManyToMany: {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
+          *_impl_.msg_.manytomany_);
+      break;
+    }
     case MSG_NOT_SET: {
       break;
     }
@@ -647,6 +732,11 @@ void Request::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOB
           from._internal_reset());
       break;
     }
+    case kManyToMany: {
+      _this->_internal_mutable_manytomany()->::esw::ManyToMany::MergeFrom(
+          from._internal_manytomany());
+      break;
+    }
     case MSG_NOT_SET: {
       break;
     }
@@ -1379,6 +1469,225 @@ const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Reset::GetClassData() const {
 
 // ===================================================================
 
+class ManyToMany::_Internal {
+ public:
+};
+
+ManyToMany::ManyToMany(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:esw.ManyToMany)
+}
+ManyToMany::ManyToMany(const ManyToMany& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  ManyToMany* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.origins_){from._impl_.origins_}
+    , decltype(_impl_.destinations_){from._impl_.destinations_}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:esw.ManyToMany)
+}
+
+inline void ManyToMany::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.origins_){arena}
+    , decltype(_impl_.destinations_){arena}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+}
+
+ManyToMany::~ManyToMany() {
+  // @@protoc_insertion_point(destructor:esw.ManyToMany)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void ManyToMany::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.origins_.~RepeatedPtrField();
+  _impl_.destinations_.~RepeatedPtrField();
+}
+
+void ManyToMany::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void ManyToMany::Clear() {
+// @@protoc_insertion_point(message_clear_start:esw.ManyToMany)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  _impl_.origins_.Clear();
+  _impl_.destinations_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* ManyToMany::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .esw.Location origins = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_origins(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      // repeated .esw.Location destinations = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 18)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_destinations(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<18>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* ManyToMany::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:esw.ManyToMany)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .esw.Location origins = 1;
+  for (unsigned i = 0,
+      n = static_cast<unsigned>(this->_internal_origins_size()); i < n; i++) {
+    const auto& repfield = this->_internal_origins(i);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+        InternalWriteMessage(1, repfield, repfield.GetCachedSize(), target, stream);
+  }
+
+  // repeated .esw.Location destinations = 2;
+  for (unsigned i = 0,
+      n = static_cast<unsigned>(this->_internal_destinations_size()); i < n; i++) {
+    const auto& repfield = this->_internal_destinations(i);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+        InternalWriteMessage(2, repfield, repfield.GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:esw.ManyToMany)
+  return target;
+}
+
+size_t ManyToMany::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:esw.ManyToMany)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .esw.Location origins = 1;
+  total_size += 1UL * this->_internal_origins_size();
+  for (const auto& msg : this->_impl_.origins_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  // repeated .esw.Location destinations = 2;
+  total_size += 1UL * this->_internal_destinations_size();
+  for (const auto& msg : this->_impl_.destinations_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData ManyToMany::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    ManyToMany::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*ManyToMany::GetClassData() const { return &_class_data_; }
+
+
+void ManyToMany::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<ManyToMany*>(&to_msg);
+  auto& from = static_cast<const ManyToMany&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:esw.ManyToMany)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  _this->_impl_.origins_.MergeFrom(from._impl_.origins_);
+  _this->_impl_.destinations_.MergeFrom(from._impl_.destinations_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void ManyToMany::CopyFrom(const ManyToMany& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:esw.ManyToMany)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool ManyToMany::IsInitialized() const {
+  return true;
+}
+
+void ManyToMany::InternalSwap(ManyToMany* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.origins_.InternalSwap(&other->_impl_.origins_);
+  _impl_.destinations_.InternalSwap(&other->_impl_.destinations_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata ManyToMany::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_scheme_2eproto_getter, &descriptor_table_scheme_2eproto_once,
+      file_level_metadata_scheme_2eproto[5]);
+}
+
+// ===================================================================
+
 class Location::_Internal {
  public:
 };
@@ -1585,7 +1894,7 @@ void Location::InternalSwap(Location* other) {
 ::PROTOBUF_NAMESPACE_ID::Metadata Location::GetMetadata() const {
   return ::_pbi::AssignDescriptors(
       &descriptor_table_scheme_2eproto_getter, &descriptor_table_scheme_2eproto_once,
-      file_level_metadata_scheme_2eproto[5]);
+      file_level_metadata_scheme_2eproto[6]);
 }
 
 // ===================================================================
@@ -1604,7 +1913,9 @@ Response::Response(const Response& from)
   : ::PROTOBUF_NAMESPACE_ID::Message() {
   Response* const _this = this; (void)_this;
   new (&_impl_) Impl_{
-      decltype(_impl_.errmsg_){}
+      decltype(_impl_.distances_){from._impl_.distances_}
+    , /*decltype(_impl_._distances_cached_byte_size_)*/{0}
+    , decltype(_impl_.errmsg_){}
     , decltype(_impl_.shortest_path_length_){}
     , decltype(_impl_.total_length_){}
     , decltype(_impl_.status_){}
@@ -1630,7 +1941,9 @@ inline void Response::SharedCtor(
   (void)arena;
   (void)is_message_owned;
   new (&_impl_) Impl_{
-      decltype(_impl_.errmsg_){}
+      decltype(_impl_.distances_){arena}
+    , /*decltype(_impl_._distances_cached_byte_size_)*/{0}
+    , decltype(_impl_.errmsg_){}
     , decltype(_impl_.shortest_path_length_){uint64_t{0u}}
     , decltype(_impl_.total_length_){uint64_t{0u}}
     , decltype(_impl_.status_){0}
@@ -1653,6 +1966,7 @@ Response::~Response() {
 
 inline void Response::SharedDtor() {
   GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.distances_.~RepeatedField();
   _impl_.errmsg_.Destroy();
 }
 
@@ -1666,6 +1980,7 @@ void Response::Clear() {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
+  _impl_.distances_.Clear();
   _impl_.errmsg_.ClearToEmpty();
   ::memset(&_impl_.shortest_path_length_, 0, static_cast<size_t>(
       reinterpret_cast<char*>(&_impl_.status_) -
@@ -1714,6 +2029,17 @@ const char* Response::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx)
         } else
           goto handle_unusual;
         continue;
+      // repeated uint64 distances = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 42)) {
+          ptr = ::PROTOBUF_NAMESPACE_ID::internal::PackedUInt64Parser(_internal_mutable_distances(), ptr, ctx);
+          CHK_(ptr);
+        } else if (static_cast<uint8_t>(tag) == 40) {
+          _internal_add_distances(::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr));
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -1772,6 +2098,15 @@ uint8_t* Response::_InternalSerialize(
     target = ::_pbi::WireFormatLite::WriteUInt64ToArray(4, this->_internal_total_length(), target);
   }
 
+  // repeated uint64 distances = 5;
+  {
+    int byte_size = _impl_._distances_cached_byte_size_.load(std::memory_order_relaxed);
+    if (byte_size > 0) {
+      target = stream->WriteUInt64Packed(
+          5, _internal_distances(), byte_size, target);
+    }
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -1788,6 +2123,20 @@ size_t Response::ByteSizeLong() const {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
+  // repeated uint64 distances = 5;
+  {
+    size_t data_size = ::_pbi::WireFormatLite::
+      UInt64Size(this->_impl_.distances_);
+    if (data_size > 0) {
+      total_size += 1 +
+        ::_pbi::WireFormatLite::Int32Size(static_cast<int32_t>(data_size));
+    }
+    int cached_size = ::_pbi::ToCachedSize(data_size);
+    _impl_._distances_cached_byte_size_.store(cached_size,
+                                    std::memory_order_relaxed);
+    total_size += data_size;
+  }
+
   // string errMsg = 2;
   if (!this->_internal_errmsg().empty()) {
     total_size += 1 +
@@ -1829,6 +2178,7 @@ void Response::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTO
   uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
+  _this->_impl_.distances_.MergeFrom(from._impl_.distances_);
   if (!from._internal_errmsg().empty()) {
     _this->_internal_set_errmsg(from._internal_errmsg());
   }
@@ -1860,6 +2210,7 @@ void Response::InternalSwap(Response* other) {
   auto* lhs_arena = GetArenaForAllocation();
   auto* rhs_arena = other->GetArenaForAllocation();
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.distances_.InternalSwap(&other->_impl_.distances_);
   ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
       &_impl_.errmsg_, lhs_arena,
       &other->_impl_.errmsg_, rhs_arena
@@ -1875,7 +2226,7 @@ void Response::InternalSwap(Response* other) {
 ::PROTOBUF_NAMESPACE_ID::Metadata Response::GetMetadata() const {
   return ::_pbi::AssignDescriptors(
       &descriptor_table_scheme_2eproto_getter, &descriptor_table_scheme_2eproto_once,
-      file_level_metadata_scheme_2eproto[6]);
+      file_level_metadata_scheme_2eproto[7]);
 }
 
 // @@protoc_insertion_point(namespace_scope)
@@ -1901,6 +2252,10 @@ template<> PROTOBUF_NOINLINE ::esw::Reset*
 Arena::CreateMaybeMessage< ::esw::Reset >(Arena* arena) {
   return Arena::CreateMessageInternal< ::esw::Reset >(arena);
 }
+template<> PROTOBUF_NOINLINE ::esw::ManyToMany*
+Arena::CreateMaybeMessage< ::esw::ManyToMany >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::esw::ManyToMany >(arena);
+}
 template<> PROTOBUF_NOINLINE ::esw::Location*
 Arena::CreateMaybeMessage< ::esw::Location >(Arena* arena) {
   return Arena::CreateMessageInternal< ::esw::Location >(arena);
@@ -50,6 +50,9 @@ namespace esw {
 class Location;
 struct LocationDefaultTypeInternal;
 extern LocationDefaultTypeInternal _Location_default_instance_;
+class ManyToMany;
+struct ManyToManyDefaultTypeInternal;
+extern ManyToManyDefaultTypeInternal _ManyToMany_default_instance_;
 class OneToAll;
 struct OneToAllDefaultTypeInternal;
 extern OneToAllDefaultTypeInternal _OneToAll_default_instance_;
@@ -71,6 +74,7 @@ extern WalkDefaultTypeInternal _Walk_default_instance_;
 }  // namespace esw
 PROTOBUF_NAMESPACE_OPEN
 template<> ::esw::Location* Arena::CreateMaybeMessage<::esw::Location>(Arena*);
+template<> ::esw::ManyToMany* Arena::CreateMaybeMessage<::esw::ManyToMany>(Arena*);
 template<> ::esw::OneToAll* Arena::CreateMaybeMessage<::esw::OneToAll>(Arena*);
 template<> ::esw::OneToOne* Arena::CreateMaybeMessage<::esw::OneToOne>(Arena*);
 template<> ::esw::Request* Arena::CreateMaybeMessage<::esw::Request>(Arena*);
@@ -155,6 +159,7 @@ class Request final :
     kOneToOne = 2,
     kOneToAll = 3,
     kReset = 4,
+    kManyToMany = 5,
     MSG_NOT_SET = 0,
   };
 
@@ -240,6 +245,7 @@ class Request final :
     kOneToOneFieldNumber = 2,
     kOneToAllFieldNumber = 3,
     kResetFieldNumber = 4,
+    kManyToManyFieldNumber = 5,
   };
   // .esw.Walk walk = 1;
   bool has_walk() const;
@@ -313,6 +319,24 @@ class Request final :
       ::esw::Reset* reset);
   ::esw::Reset* unsafe_arena_release_reset();
 
+  // .esw.ManyToMany manyToMany = 5;
+  bool has_manytomany() const;
+  private:
+  bool _internal_has_manytomany() const;
+  public:
+  void clear_manytomany();
+  const ::esw::ManyToMany& manytomany() const;
+  PROTOBUF_NODISCARD ::esw::ManyToMany* release_manytomany();
+  ::esw::ManyToMany* mutable_manytomany();
+  void set_allocated_manytomany(::esw::ManyToMany* manytomany);
+  private:
+  const ::esw::ManyToMany& _internal_manytomany() const;
+  ::esw::ManyToMany* _internal_mutable_manytomany();
+  public:
+  void unsafe_arena_set_allocated_manytomany(
+      ::esw::ManyToMany* manytomany);
+  ::esw::ManyToMany* unsafe_arena_release_manytomany();
+
   void clear_msg();
   MsgCase msg_case() const;
   // @@protoc_insertion_point(class_scope:esw.Request)
@@ -322,6 +346,7 @@ class Request final :
   void set_has_onetoone();
   void set_has_onetoall();
   void set_has_reset();
+  void set_has_manytomany();
 
   inline bool has_msg() const;
   inline void clear_has_msg();
@@ -337,6 +362,7 @@ class Request final :
       ::esw::OneToOne* onetoone_;
       ::esw::OneToAll* onetoall_;
       ::esw::Reset* reset_;
+      ::esw::ManyToMany* manytomany_;
     } msg_;
     mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
     uint32_t _oneof_case_[1];
@@ -981,6 +1007,183 @@ class Reset final :
 };
 // -------------------------------------------------------------------
 
+class ManyToMany final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:esw.ManyToMany) */ {
+ public:
+  inline ManyToMany() : ManyToMany(nullptr) {}
+  ~ManyToMany() override;
+  explicit PROTOBUF_CONSTEXPR ManyToMany(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  ManyToMany(const ManyToMany& from);
+  ManyToMany(ManyToMany&& from) noexcept
+    : ManyToMany() {
+    *this = ::std::move(from);
+  }
+
+  inline ManyToMany& operator=(const ManyToMany& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline ManyToMany& operator=(ManyToMany&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const ManyToMany& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const ManyToMany* internal_default_instance() {
+    return reinterpret_cast<const ManyToMany*>(
+               &_ManyToMany_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    5;
+
+  friend void swap(ManyToMany& a, ManyToMany& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(ManyToMany* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(ManyToMany* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  ManyToMany* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<ManyToMany>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const ManyToMany& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const ManyToMany& from) {
+    ManyToMany::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(ManyToMany* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "esw.ManyToMany";
+  }
+  protected:
+  explicit ManyToMany(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kOriginsFieldNumber = 1,
+    kDestinationsFieldNumber = 2,
+  };
+  // repeated .esw.Location origins = 1;
+  int origins_size() const;
+  private:
+  int _internal_origins_size() const;
+  public:
+  void clear_origins();
+  ::esw::Location* mutable_origins(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >*
+      mutable_origins();
+  private:
+  const ::esw::Location& _internal_origins(int index) const;
+  ::esw::Location* _internal_add_origins();
+  public:
+  const ::esw::Location& origins(int index) const;
+  ::esw::Location* add_origins();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >&
+      origins() const;
+
+  // repeated .esw.Location destinations = 2;
+  int destinations_size() const;
+  private:
+  int _internal_destinations_size() const;
+  public:
+  void clear_destinations();
+  ::esw::Location* mutable_destinations(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >*
+      mutable_destinations();
+  private:
+  const ::esw::Location& _internal_destinations(int index) const;
+  ::esw::Location* _internal_add_destinations();
+  public:
+  const ::esw::Location& destinations(int index) const;
+  ::esw::Location* add_destinations();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >&
+      destinations() const;
+
+  // @@protoc_insertion_point(class_scope:esw.ManyToMany)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location > origins_;
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location > destinations_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_scheme_2eproto;
+};
+// -------------------------------------------------------------------
+
 class Location final :
     public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:esw.Location) */ {
  public:
@@ -1029,7 +1232,7 @@ class Location final :
                &_Location_default_instance_);
   }
   static constexpr int kIndexInFileMessages =
-    5;
+    6;
 
   friend void swap(Location& a, Location& b) {
     a.Swap(&b);
@@ -1188,7 +1391,7 @@ class Response final :
                &_Response_default_instance_);
   }
   static constexpr int kIndexInFileMessages =
-    6;
+    7;
 
   friend void swap(Response& a, Response& b) {
     a.Swap(&b);
@@ -1291,11 +1494,34 @@ class Response final :
   // accessors -------------------------------------------------------
 
   enum : int {
+    kDistancesFieldNumber = 5,
     kErrMsgFieldNumber = 2,
     kShortestPathLengthFieldNumber = 3,
     kTotalLengthFieldNumber = 4,
     kStatusFieldNumber = 1,
   };
+  // repeated uint64 distances = 5;
+  int distances_size() const;
+  private:
+  int _internal_distances_size() const;
+  public:
+  void clear_distances();
+  private:
+  uint64_t _internal_distances(int index) const;
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >&
+      _internal_distances() const;
+  void _internal_add_distances(uint64_t value);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >*
+      _internal_mutable_distances();
+  public:
+  uint64_t distances(int index) const;
+  void set_distances(int index, uint64_t value);
+  void add_distances(uint64_t value);
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >&
+      distances() const;
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >*
+      mutable_distances();
+
   // string errMsg = 2;
   void clear_errmsg();
   const std::string& errmsg() const;
@@ -1345,6 +1571,8 @@ class Response final :
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
   struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t > distances_;
+    mutable std::atomic<int> _distances_cached_byte_size_;
     ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr errmsg_;
     uint64_t shortest_path_length_;
     uint64_t total_length_;
@@ -1661,6 +1889,80 @@ inline ::esw::Reset* Request::mutable_reset() {
   return _msg;
 }
 
+// .esw.ManyToMany manyToMany = 5;
+inline bool Request::_internal_has_manytomany() const {
+  return msg_case() == kManyToMany;
+}
+inline bool Request::has_manytomany() const {
+  return _internal_has_manytomany();
+}
+inline void Request::set_has_manytomany() {
+  _impl_._oneof_case_[0] = kManyToMany;
+}
+inline void Request::clear_manytomany() {
+  if (_internal_has_manytomany()) {
+    if (GetArenaForAllocation() == nullptr) {
+      delete _impl_.msg_.manytomany_;
+    }
+    clear_has_msg();
+  }
+}
+inline ::esw::ManyToMany* Request::release_manytomany() {
+  // @@protoc_insertion_point(field_release:esw.Request.manyToMany)
+  if (_internal_has_manytomany()) {
+    clear_has_msg();
+    ::esw::ManyToMany* temp = _impl_.msg_.manytomany_;
+    if (GetArenaForAllocation() != nullptr) {
+      temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+    }
+    _impl_.msg_.manytomany_ = nullptr;
+    return temp;
+  } else {
+    return nullptr;
+  }
+}
+inline const ::esw::ManyToMany& Request::_internal_manytomany() const {
+  return _internal_has_manytomany()
+      ? *_impl_.msg_.manytomany_
+      : reinterpret_cast< ::esw::ManyToMany&>(::esw::_ManyToMany_default_instance_);
+}
+inline const ::esw::ManyToMany& Request::manytomany() const {
+  // @@protoc_insertion_point(field_get:esw.Request.manyToMany)
+  return _internal_manytomany();
+}
+inline ::esw::ManyToMany* Request::unsafe_arena_release_manytomany() {
+  // @@protoc_insertion_point(field_unsafe_arena_release:esw.Request.manyToMany)
+  if (_internal_has_manytomany()) {
+    clear_has_msg();
+    ::esw::ManyToMany* temp = _impl_.msg_.manytomany_;
+    _impl_.msg_.manytomany_ = nullptr;
+    return temp;
+  } else {
+    return nullptr;
+  }
+}
+inline void Request::unsafe_arena_set_allocated_manytomany(::esw::ManyToMany* manytomany) {
+  clear_msg();
+  if (manytomany) {
+    set_has_manytomany();
+    _impl_.msg_.manytomany_ = manytomany;
+  }
+  // @@protoc_insertion_point(field_unsafe_arena_set_allocated:esw.Request.manyToMany)
+}
+inline ::esw::ManyToMany* Request::_internal_mutable_manytomany() {
+  if (!_internal_has_manytomany()) {
+    clear_msg();
+    set_has_manytomany();
+    _impl_.msg_.manytomany_ = CreateMaybeMessage< ::esw::ManyToMany >(GetArenaForAllocation());
+  }
+  return _impl_.msg_.manytomany_;
+}
+inline ::esw::ManyToMany* Request::mutable_manytomany() {
+  ::esw::ManyToMany* _msg = _internal_mutable_manytomany();
+  // @@protoc_insertion_point(field_mutable:esw.Request.manyToMany)
+  return _msg;
+}
+
 inline bool Request::has_msg() const {
   return msg_case() != MSG_NOT_SET;
 }
@@ -2045,6 +2347,90 @@ inline void OneToAll::set_allocated_origin(::esw::Location* origin) {
 
 // -------------------------------------------------------------------
 
+// ManyToMany
+
+// repeated .esw.Location origins = 1;
+inline int ManyToMany::_internal_origins_size() const {
+  return _impl_.origins_.size();
+}
+inline int ManyToMany::origins_size() const {
+  return _internal_origins_size();
+}
+inline void ManyToMany::clear_origins() {
+  _impl_.origins_.Clear();
+}
+inline ::esw::Location* ManyToMany::mutable_origins(int index) {
+  // @@protoc_insertion_point(field_mutable:esw.ManyToMany.origins)
+  return _impl_.origins_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >*
+ManyToMany::mutable_origins() {
+  // @@protoc_insertion_point(field_mutable_list:esw.ManyToMany.origins)
+  return &_impl_.origins_;
+}
+inline const ::esw::Location& ManyToMany::_internal_origins(int index) const {
+  return _impl_.origins_.Get(index);
+}
+inline const ::esw::Location& ManyToMany::origins(int index) const {
+  // @@protoc_insertion_point(field_get:esw.ManyToMany.origins)
+  return _internal_origins(index);
+}
+inline ::esw::Location* ManyToMany::_internal_add_origins() {
+  return _impl_.origins_.Add();
+}
+inline ::esw::Location* ManyToMany::add_origins() {
+  ::esw::Location* _add = _internal_add_origins();
+  // @@protoc_insertion_point(field_add:esw.ManyToMany.origins)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >&
+ManyToMany::origins() const {
+  // @@protoc_insertion_point(field_list:esw.ManyToMany.origins)
+  return _impl_.origins_;
+}
+
+// repeated .esw.Location destinations = 2;
+inline int ManyToMany::_internal_destinations_size() const {
+  return _impl_.destinations_.size();
+}
+inline int ManyToMany::destinations_size() const {
+  return _internal_destinations_size();
+}
+inline void ManyToMany::clear_destinations() {
+  _impl_.destinations_.Clear();
+}
+inline ::esw::Location* ManyToMany::mutable_destinations(int index) {
+  // @@protoc_insertion_point(field_mutable:esw.ManyToMany.destinations)
+  return _impl_.destinations_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >*
+ManyToMany::mutable_destinations() {
+  // @@protoc_insertion_point(field_mutable_list:esw.ManyToMany.destinations)
+  return &_impl_.destinations_;
+}
+inline const ::esw::Location& ManyToMany::_internal_destinations(int index) const {
+  return _impl_.destinations_.Get(index);
+}
+inline const ::esw::Location& ManyToMany::destinations(int index) const {
+  // @@protoc_insertion_point(field_get:esw.ManyToMany.destinations)
+  return _internal_destinations(index);
+}
+inline ::esw::Location* ManyToMany::_internal_add_destinations() {
+  return _impl_.destinations_.Add();
+}
+inline ::esw::Location* ManyToMany::add_destinations() {
+  ::esw::Location* _add = _internal_add_destinations();
+  // @@protoc_insertion_point(field_add:esw.ManyToMany.destinations)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::esw::Location >&
+ManyToMany::destinations() const {
+  // @@protoc_insertion_point(field_list:esw.ManyToMany.destinations)
+  return _impl_.destinations_;
+}
+
+// -------------------------------------------------------------------
+
 // Location
 
 // int32 x = 1;
@@ -2201,6 +2587,53 @@ inline void Response::set_total_length(uint64_t value) {
   // @@protoc_insertion_point(field_set:esw.Response.total_length)
 }
 
+// repeated uint64 distances = 5;
+inline int Response::_internal_distances_size() const {
+  return _impl_.distances_.size();
+}
+inline int Response::distances_size() const {
+  return _internal_distances_size();
+}
+inline void Response::clear_distances() {
+  _impl_.distances_.Clear();
+}
+inline uint64_t Response::_internal_distances(int index) const {
+  return _impl_.distances_.Get(index);
+}
+inline uint64_t Response::distances(int index) const {
+  // @@protoc_insertion_point(field_get:esw.Response.distances)
+  return _internal_distances(index);
+}
+inline void Response::set_distances(int index, uint64_t value) {
+  _impl_.distances_.Set(index, value);
+  // @@protoc_insertion_point(field_set:esw.Response.distances)
+}
+inline void Response::_internal_add_distances(uint64_t value) {
+  _impl_.distances_.Add(value);
+}
+inline void Response::add_distances(uint64_t value) {
+  _internal_add_distances(value);
+  // @@protoc_insertion_point(field_add:esw.Response.distances)
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >&
+Response::_internal_distances() const {
+  return _impl_.distances_;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >&
+Response::distances() const {
+  // @@protoc_insertion_point(field_list:esw.Response.distances)
+  return _internal_distances();
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >*
+Response::_internal_mutable_distances() {
+  return &_impl_.distances_;
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint64_t >*
+Response::mutable_distances() {
+  // @@protoc_insertion_point(field_mutable_list:esw.Response.distances)
+  return _internal_mutable_distances();
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -2216,6 +2649,8 @@ inline void Response::set_total_length(uint64_t value) {
 
 // -------------------------------------------------------------------
 
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
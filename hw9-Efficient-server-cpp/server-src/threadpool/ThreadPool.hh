@@ -39,6 +39,10 @@ public:
 
     void run(function<void()> task, int id);
 
+    size_t size() const {
+        return threads.size();
+    }
+
     void shutdown();
 };
 
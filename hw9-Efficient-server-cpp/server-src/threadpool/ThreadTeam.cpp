@@ -0,0 +1,80 @@
+
+#include "ThreadTeam.hh"
+
+// Global variables -------------------------------------------------------------------------------
+
+// Class definition -------------------------------------------------------------------------------
+ThreadTeam::ThreadTeam(ThreadPool &pool, uint32_t helpers) :
+        state(make_shared<State>()),
+        capacity(helpers + 1)
+{
+    for (uint32_t i = 0; i < helpers; i++) {
+        pool.run([state = state]() { help(state); }, -1);
+    }
+}
+
+ThreadTeam::~ThreadTeam() {
+    // Helpers still queued in the pool find the team dismissed and return at once
+    state->phase.store(DISMISSED);
+    state->phase.notify_all();
+}
+
+void ThreadTeam::claimChunks(State &state, uint32_t member) {
+    while (true) {
+        size_t begin = state.next.fetch_add(state.chunk);
+        if (begin >= state.count) return;
+        (*state.body)(member, begin, min(begin + state.chunk, state.count));
+    }
+}
+
+void ThreadTeam::help(const shared_ptr<State> &state) {
+    uint32_t member = state->members.fetch_add(1);
+    uint64_t done = 0;
+
+    while (true) {
+        uint64_t phase = state->phase.load();
+        if (phase == DISMISSED) return;
+        if (phase % 2 == 1 || phase == done) {
+            state->phase.wait(phase);
+            continue;
+        }
+
+        // Enter the loop only if it was not closed in the meantime, the caller waits for entered members
+        state->working.fetch_add(1);
+        if (state->phase.load() == phase) {
+            claimChunks(*state, member);
+            done = phase;
+        }
+        if (state->working.fetch_sub(1) == 1) {
+            state->working.notify_all();
+        }
+    }
+}
+
+void ThreadTeam::parallelFor(size_t count, size_t chunk,
+                             const function<void(uint32_t, size_t, size_t)> &body) {
+    if (count == 0) return;
+    if (count <= chunk || capacity == 1) {
+        body(0, 0, count);
+        return;
+    }
+
+    State &current = *state;
+    current.count = count;
+    current.chunk = chunk;
+    current.body = &body;
+    current.next.store(0);
+
+    uint64_t phase = current.phase.load() + 1;
+    current.phase.store(phase);
+    current.phase.notify_all();
+
+    claimChunks(current, 0);
+
+    // Close the loop and wait for the members still working on their last chunk
+    current.phase.store(phase + 1);
+    uint32_t working;
+    while ((working = current.working.load()) != 0) {
+        current.working.wait(working);
+    }
+}
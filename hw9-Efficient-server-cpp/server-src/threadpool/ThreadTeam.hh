@@ -0,0 +1,57 @@
+#ifndef THREADTEAM_HH
+#define THREADTEAM_HH
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <limits>
+
+#include "ThreadPool.hh"
+
+// Global variables -------------------------------------------------------------------------------
+
+// Class definition -------------------------------------------------------------------------------
+using namespace std;
+
+/**
+ * Fork-join team of pool threads for data parallel loops. Helpers are requested from the pool once per
+ * team and join whenever a pool thread picks them up, the calling thread always takes part. The team
+ * never waits for a helper that has not joined yet, so it makes progress even on a saturated pool.
+ */
+class ThreadTeam {
+private:
+    static constexpr uint64_t DISMISSED = numeric_limits<uint64_t>::max();
+
+    struct State {
+        atomic<uint64_t> phase;         // even while a loop is open, odd while the team is idle
+        atomic<uint32_t> working;       // members inside the open loop
+        atomic<uint32_t> members;       // next member id, the calling thread is member 0
+        atomic<size_t> next;            // next iteration to claim
+        size_t count;
+        size_t chunk;
+        const function<void(uint32_t, size_t, size_t)> *body;
+
+        State() : phase(1), working(0), members(1), next(0), count(0), chunk(1), body(nullptr) {}
+    };
+
+    shared_ptr<State> state;
+    uint32_t capacity;
+
+    static void claimChunks(State &state, uint32_t member);
+
+    static void help(const shared_ptr<State> &state);
+public:
+    ThreadTeam(ThreadPool &pool, uint32_t helpers);
+
+    ~ThreadTeam();
+
+    // Upper bound on the member ids passed to the loop bodies
+    uint32_t size() const {
+        return capacity;
+    }
+
+    // Runs body(member, begin, end) over [0, count) in chunks on all members present, returns when done
+    void parallelFor(size_t count, size_t chunk, const function<void(uint32_t, size_t, size_t)> &body);
+};
+
+#endif // THREADTEAM_HH
@@ -0,0 +1,87 @@
+#include <thread>
+#include <chrono>
+
+#include "GridTests.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// Identical queries sent while the first one searches
+#define TEST_COALESCED_QUERIES  8
+
+// Class definition -------------------------------------------------------------------------------
+// Result at the version of the query, the search runs only on a miss and counts itself
+static uint64_t cachedQuery(QueryCache &cache, const QueryKey &key, uint64_t version, uint64_t value,
+                            atomic<uint32_t> &searches) {
+    return cache.getOrCompute(key, version, [&searches, value]() {
+        searches++;
+        return value;
+    });
+}
+
+// A result serves its version only, a newer version replaces it and an older one never evicts it
+bool testQueryCacheVersions() {
+    QueryCache cache(1024);
+    atomic<uint32_t> searches(0);
+    QueryKey oneToOne = {1, 2, false};
+    QueryKey oneToAll = {1, 2, true};
+
+    TEST_CHECK(cachedQuery(cache, oneToOne, 5, 50, searches) == 50 && searches == 1, "first query did not search");
+    TEST_CHECK(cachedQuery(cache, oneToOne, 5, 0, searches) == 50 && searches == 1,
+               "query at the same version is searched again");
+    TEST_CHECK(cachedQuery(cache, oneToAll, 5, 70, searches) == 70 && searches == 2,
+               "OneToAll query answered with the OneToOne result of the same cells");
+    TEST_CHECK(cachedQuery(cache, oneToOne, 6, 60, searches) == 60 && searches == 3,
+               "query at a newer version answered with the older result");
+    TEST_CHECK(cachedQuery(cache, oneToOne, 5, 51, searches) == 51 && searches == 4,
+               "query at an older version answered with the newer result");
+    TEST_CHECK(cachedQuery(cache, oneToOne, 6, 0, searches) == 60 && searches == 4,
+               "query at an older version evicted the newer result");
+
+    cache.clear();
+    TEST_CHECK(cachedQuery(cache, oneToOne, 6, 61, searches) == 61 && searches == 5, "clear kept a result");
+    return true;
+}
+
+// Every query arriving while the first one searches waits for its result, whatever the timing
+bool testQueryCacheCoalescing() {
+    QueryCache cache(1024);
+    atomic<uint32_t> searches(0);
+    QueryKey key = {3, 4, false};
+    vector<thread> followers;
+    vector<uint64_t> results(TEST_COALESCED_QUERIES);
+
+    // The entry of the first query is in the cache before its search runs, the followers start from the search
+    uint64_t first = cache.getOrCompute(key, 1, [&]() {
+        searches++;
+        for (uint32_t i = 0; i < TEST_COALESCED_QUERIES; i++) {
+            followers.emplace_back([&, i]() {
+                results[i] = cachedQuery(cache, key, 1, 0, searches);
+            });
+        }
+        // Most followers are blocked on the result in flight by now
+        this_thread::sleep_for(chrono::milliseconds(20));
+        return uint64_t(42);
+    });
+    for (thread &follower: followers) follower.join();
+
+    TEST_CHECK(first == 42, "first query answered %lu", first);
+    TEST_CHECK(searches == 1, "%u searches for identical queries", searches.load());
+    for (uint64_t result: results) TEST_CHECK(result == 42, "query waiting for the search answered %lu", result);
+    return true;
+}
+
+// Shards keep their most recently used entries, the queries beyond the capacity are searched again
+bool testQueryCacheEviction() {
+    QueryCache cache(QUERY_CACHE_SHARDS);
+    atomic<uint32_t> searches(0);
+    const uint32_t queries = QUERY_CACHE_SHARDS * 4;
+    for (uint32_t round = 0; round < 2; round++) {
+        for (uint64_t origin = 0; origin < queries; origin++) {
+            uint64_t result = cachedQuery(cache, {origin, 0, true}, 1, origin * 10, searches);
+            TEST_CHECK(result == origin * 10, "query from %lu answered %lu", origin, result);
+        }
+    }
+    // One entry a shard survives the first round at most
+    TEST_CHECK(searches >= 2 * queries - QUERY_CACHE_SHARDS, "%u searches for %u queries over a capacity of %d",
+               searches.load(), 2 * queries, QUERY_CACHE_SHARDS);
+    return true;
+}
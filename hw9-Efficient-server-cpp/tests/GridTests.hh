@@ -0,0 +1,68 @@
+#ifndef TESTS_GRID_TESTS_HH
+#define TESTS_GRID_TESTS_HH
+
+#include <random>
+
+#include "GridModel.hh"
+#include "ThreadPool.hh"
+#include "CityWalks.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// Walks of the city every test grid starts from
+#define TEST_CITY_WALKS     3000
+#define TEST_ONE_TO_ALL     5
+#define TEST_ONE_TO_ONE     100
+
+extern PrefixedLogger testLogger;
+
+extern GridData gridData;
+extern GridStats gridStats;
+
+extern ThreadPool resourcePool1;
+
+// Fails the running test with the message unless the condition holds
+#define TEST_CHECK(condition, ...)          \
+    do {                                    \
+        if (!(condition)) {                 \
+            testLogger.error(__VA_ARGS__);  \
+            return false;                   \
+        }                                   \
+    } while (0)
+
+// Class definition -------------------------------------------------------------------------------
+// Search checks, every search and queue has to agree with the plain Dijkstra
+bool testSearchQueues();
+
+bool testDeltaStepping();
+
+bool testIncrementalOneToAll();
+
+bool testSnapshotUpdate();
+
+bool testDijkstraToMany();
+
+bool testManyToMany();
+
+// Cell resolution checks
+bool testBatchResolution();
+
+// Query cache checks
+bool testQueryCacheVersions();
+
+bool testQueryCacheCoalescing();
+
+bool testQueryCacheEviction();
+
+// Ingest queue checks
+bool testIngestQueueOrder();
+
+bool testIngestQueueWait();
+
+// Snapshot and write-ahead log checks
+bool testSnapshotRoundTrip();
+
+bool testSnapshotValidation();
+
+bool testLogReplay();
+
+#endif //TESTS_GRID_TESTS_HH
@@ -0,0 +1,77 @@
+#include <thread>
+#include <chrono>
+
+#include "GridTests.hh"
+
+// Global variables -------------------------------------------------------------------------------
+#define TEST_PRODUCERS          4
+#define TEST_PRODUCER_REQUESTS  5000
+#define TEST_BATCH              64
+
+// Class definition -------------------------------------------------------------------------------
+// Request of a producer carrying its number and its sequence in the lengths of a walk
+static IngestRequest numberedRequest(uint32_t producer, uint32_t sequence) {
+    IngestRequest item;
+    item.request.mutable_walk()->add_lengths(producer);
+    item.request.mutable_walk()->add_lengths(sequence);
+    return item;
+}
+
+// Requests of concurrent producers all arrive once, in batches of at most the maximum and in the order of
+// their producer
+bool testIngestQueueOrder() {
+    IngestQueue queue;
+    vector<thread> producers;
+    for (uint32_t producer = 0; producer < TEST_PRODUCERS; producer++) {
+        producers.emplace_back([&queue, producer]() {
+            for (uint32_t sequence = 0; sequence < TEST_PRODUCER_REQUESTS; sequence++) {
+                queue.push(numberedRequest(producer, sequence));
+            }
+        });
+    }
+
+    vector<uint32_t> next(TEST_PRODUCERS, 0);
+    vector<IngestRequest> batch;
+    for (uint32_t received = 0; received < TEST_PRODUCERS * TEST_PRODUCER_REQUESTS; received += batch.size()) {
+        batch.clear();
+        queue.popBatch(batch, TEST_BATCH);
+        TEST_CHECK(!batch.empty() && batch.size() <= TEST_BATCH, "batch of %lu requests", batch.size());
+        for (const IngestRequest &item: batch) {
+            uint32_t producer = item.request.walk().lengths(0);
+            uint32_t sequence = item.request.walk().lengths(1);
+            TEST_CHECK(producer < TEST_PRODUCERS && sequence == next[producer],
+                       "request %u of producer %u arrived instead of %u", sequence, producer, next[producer]);
+            next[producer]++;
+        }
+    }
+    for (thread &producer: producers) producer.join();
+
+    batch.clear();
+    queue.popBatch(batch, TEST_BATCH, false);
+    TEST_CHECK(batch.empty(), "%lu requests arrived twice", batch.size());
+    return true;
+}
+
+// An empty queue returns at once unless told to wait, a waiting writer wakes up on the next push
+bool testIngestQueueWait() {
+    IngestQueue queue;
+    vector<IngestRequest> batch;
+    queue.popBatch(batch, TEST_BATCH, false);
+    TEST_CHECK(batch.empty(), "empty queue returned %lu requests", batch.size());
+
+    atomic<bool> answered(false);
+    thread writer([&]() {
+        queue.popBatch(batch, TEST_BATCH);
+        for (IngestRequest &item: batch) item.done();
+    });
+    // The writer is most likely asleep by now, the push has to wake it either way
+    this_thread::sleep_for(chrono::milliseconds(20));
+    IngestRequest item = numberedRequest(0, 0);
+    item.done = [&answered]() { answered = true; };
+    queue.push(std::move(item));
+    writer.join();
+
+    TEST_CHECK(batch.size() == 1, "waiting writer took %lu requests", batch.size());
+    TEST_CHECK(answered, "request was not answered");
+    return true;
+}
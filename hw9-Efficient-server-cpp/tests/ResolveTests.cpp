@@ -0,0 +1,72 @@
+#include <memory>
+
+#include "GridTests.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// Walks resolved by both paths and their locations, sampled around the cells of the test city
+#define TEST_RESOLVE_WALKS      400
+#define TEST_RESOLVE_LOCATIONS  200
+#define TEST_RESOLVE_JITTER     400
+
+// Class definition -------------------------------------------------------------------------------
+// Locations of a walk near the cells of the grid and in new areas, negative ones resolve through the
+// sign-extended points of their cells
+static vector<Point> walkPoints(mt19937_64 &random, const vector<Point> &cellPoints) {
+    uniform_int_distribution<int32_t> jitter(-TEST_RESOLVE_JITTER, TEST_RESOLVE_JITTER);
+    uniform_int_distribution<int32_t> anywhere(-30000000, 30000000);
+    vector<Point> points;
+    for (int i = 0; i < TEST_RESOLVE_LOCATIONS; i++) {
+        int32_t x;
+        int32_t y;
+        if (random() % 8 == 0) {
+            x = anywhere(random);
+            y = anywhere(random);
+        } else {
+            const Point &cell = cellPoints[random() % cellPoints.size()];
+            x = static_cast<int32_t>(cell.x) + jitter(random);
+            y = static_cast<int32_t>(cell.y) + jitter(random);
+        }
+        // Widened like the locations of a walk message
+        points.push_back({static_cast<uint64_t>(x), static_cast<uint64_t>(y)});
+    }
+    return points;
+}
+
+// The batch resolves every location of a walk to the cell getPointCellId resolves it to, and adds the same cells
+bool testBatchResolution() {
+    mt19937_64 random(12);
+    generateCityWalks(gridData, gridStats, random, TEST_CITY_WALKS);
+    vector<Point> cellPoints;
+    for (uint64_t cellId: gridData.cellIds) {
+        cellPoints.push_back(gridData.cells[cellId % CHUNKS].find(cellId)->second.point());
+    }
+
+    // The second grid starts with the same cells in the same order
+    auto batched = make_unique<GridData>();
+    GridStats batchedStats;
+    vector<uint64_t> pointCellIds;
+    for (uint32_t index = 0; index < cellPoints.size(); index++) {
+        uint64_t cellId = gridData.cellIds[index];
+        batched->addPoint(batchedStats, cellPoints[index], cellId);
+    }
+    TEST_CHECK(batched->cellIds == gridData.cellIds, "copy of the grid has %lu cells instead of %lu",
+               batched->cellIds.size(), gridData.cellIds.size());
+
+    for (int walk = 0; walk < TEST_RESOLVE_WALKS; walk++) {
+        vector<Point> points = walkPoints(random, cellPoints);
+        vector<Point> batchPoints = points;
+        batched->addWalkPoints(batchedStats, batchPoints, pointCellIds);
+        TEST_CHECK(pointCellIds.size() == points.size(), "%lu cells for %lu locations", pointCellIds.size(),
+                   points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            uint64_t cellId = gridData.getPointCellId(points[i]);
+            gridData.addPoint(gridStats, points[i], cellId);
+            TEST_CHECK(pointCellIds[i] == cellId, "location %lu of walk %d at %ld, %ld resolved to %lu instead of %lu",
+                       i, walk, static_cast<int64_t>(points[i].x), static_cast<int64_t>(points[i].y),
+                       pointCellIds[i], cellId);
+        }
+    }
+    TEST_CHECK(batched->cellIds == gridData.cellIds, "batch added %lu cells instead of %lu",
+               batched->cellIds.size(), gridData.cellIds.size());
+    return true;
+}
@@ -0,0 +1,223 @@
+#include "GridTests.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// Walks between two checks of the searches kept over walks
+#define TEST_DRIFT_WALKS    20
+// Side of the ManyToMany matrix, and a location far outside the city that is in no cell
+#define TEST_MATRIX_SIDE    12
+#define TEST_NOWHERE        2000000000
+
+// Class definition -------------------------------------------------------------------------------
+// Snapshot of the test city, with the origins and pairs the searches are checked on
+struct CityQueries {
+    shared_ptr<const GridSnapshot> snapshot;
+    vector<uint32_t> origins;
+    vector<pair<uint32_t, uint32_t>> pairs;
+};
+
+static CityQueries cityQueries(mt19937_64 &random) {
+    generateCityWalks(gridData, gridStats, random, TEST_CITY_WALKS);
+    CityQueries queries;
+    queries.snapshot = gridData.publishSnapshot();
+    uint32_t size = queries.snapshot->graph.size();
+    for (int i = 0; i < TEST_ONE_TO_ALL; i++) queries.origins.push_back(random() % size);
+    for (int i = 0; i < TEST_ONE_TO_ONE; i++) queries.pairs.push_back({random() % size, random() % size});
+    return queries;
+}
+
+// Exact OneToOne distances of the pairs on the graph
+static vector<uint64_t> exactDistances(const GridGraph &graph, const vector<pair<uint32_t, uint32_t>> &pairs) {
+    vector<uint64_t> distances;
+    for (const auto &[originIndex, destinationIndex]: pairs) {
+        distances.push_back(dijkstra(graph, originIndex, destinationIndex, ONE_TO_ONE));
+    }
+    return distances;
+}
+
+template<typename Queue>
+static bool searchesAgree(const char *queueName, const CityQueries &queries, const vector<uint64_t> &totals,
+                          const vector<uint64_t> &distances) {
+    const GridGraph &graph = queries.snapshot->graph;
+    const ChainGraph &chainGraph = queries.snapshot->getChainGraph();
+    for (size_t i = 0; i < queries.origins.size(); i++) {
+        uint32_t originIndex = queries.origins[i];
+        TEST_CHECK(dijkstra<Queue>(graph, originIndex, NO_CELL, ONE_TO_ALL) == totals[i],
+                   "%s OneToAll from %u differs", queueName, originIndex);
+        TEST_CHECK(chainDijkstra<Queue>(graph, chainGraph, originIndex) == totals[i],
+                   "%s chain OneToAll from %u differs", queueName, originIndex);
+    }
+    for (size_t i = 0; i < queries.pairs.size(); i++) {
+        auto [originIndex, destinationIndex] = queries.pairs[i];
+        TEST_CHECK(dijkstra<Queue>(graph, originIndex, destinationIndex, ONE_TO_ONE) == distances[i],
+                   "%s OneToOne from %u to %u differs", queueName, originIndex, destinationIndex);
+        TEST_CHECK(bidirectionalDijkstra<Queue>(graph, originIndex, destinationIndex) == distances[i],
+                   "%s bidirectional OneToOne from %u to %u differs", queueName, originIndex, destinationIndex);
+        TEST_CHECK(aStar<Queue>(graph, originIndex, destinationIndex) == distances[i],
+                   "%s A* OneToOne from %u to %u differs", queueName, originIndex, destinationIndex);
+    }
+    return true;
+}
+
+bool testSearchQueues() {
+    mt19937_64 random(1);
+    CityQueries queries = cityQueries(random);
+    const GridGraph &graph = queries.snapshot->graph;
+
+    vector<uint64_t> totals;
+    for (uint32_t originIndex: queries.origins) totals.push_back(dijkstra(graph, originIndex, NO_CELL, ONE_TO_ALL));
+    vector<uint64_t> distances = exactDistances(graph, queries.pairs);
+    return searchesAgree<BinaryHeapQueue>("binary heap", queries, totals, distances) &&
+           searchesAgree<RadixHeapQueue>("radix heap", queries, totals, distances) &&
+           searchesAgree<IndexedDaryHeapQueue<4>>("indexed 4-ary heap", queries, totals, distances);
+}
+
+bool testDeltaStepping() {
+    mt19937_64 random(2);
+    CityQueries queries = cityQueries(random);
+    const GridGraph &graph = queries.snapshot->graph;
+    const ChainGraph &chainGraph = queries.snapshot->getChainGraph();
+
+    uint32_t helpers = resourcePool1.size();
+    for (uint32_t originIndex: queries.origins) {
+        uint64_t expected = dijkstra(graph, originIndex, NO_CELL, ONE_TO_ALL);
+        uint64_t total = deltaStepping(graph, chainGraph, originIndex, resourcePool1, helpers);
+        TEST_CHECK(total == expected, "delta-stepping OneToAll from %u is %lu instead of %lu", originIndex, total,
+                   expected);
+    }
+    return true;
+}
+
+// The path tree of one origin is updated between bursts of walks instead of searched again
+bool testIncrementalOneToAll() {
+    mt19937_64 random(3);
+    CityQueries queries = cityQueries(random);
+    uint32_t originIndex = queries.origins[0];
+    uint64_t originCellId = gridData.cellIds[originIndex];
+    function<uint64_t()> unused = []() { return uint64_t(0); };
+    gridData.pathTrees.totalLength(*queries.snapshot, originCellId, originIndex, unused);
+    gridData.pathTrees.totalLength(*queries.snapshot, originCellId, originIndex, unused);
+
+    for (int round = 0; round < TEST_DRIFT_WALKS; round++) {
+        generateCityWalks(gridData, gridStats, random, 5);
+        shared_ptr<const GridSnapshot> current = gridData.publishSnapshot();
+        uint64_t incremental = gridData.pathTrees.totalLength(*current, originCellId, originIndex, unused);
+        uint64_t full = chainDijkstra(current->graph, current->getChainGraph(), originIndex);
+        TEST_CHECK(incremental == full, "incremental OneToAll differs in round %d: %lu instead of %lu", round,
+                   incremental, full);
+    }
+    return true;
+}
+
+// Snapshots published walk by walk lay out the same graph and cell index as built from scratch
+bool testSnapshotUpdate() {
+    mt19937_64 random(8);
+    CityQueries queries = cityQueries(random);
+    auto sameArcs = [](span<const GraphArc> first, span<const GraphArc> second) {
+        return equal(first.begin(), first.end(), second.begin(), second.end(),
+                     [](const GraphArc &one, const GraphArc &other) {
+                         return one.target == other.target && one.weight == other.weight;
+                     });
+    };
+    shared_ptr<const GridSnapshot> previous = gridData.publishSnapshot();
+    for (int walk = 0; walk < TEST_DRIFT_WALKS; walk++) {
+        generateCityWalks(gridData, gridStats, random, 1);
+        shared_ptr<const GridSnapshot> current = gridData.publishSnapshot();
+        GridGraph graph;
+        graph.build(gridData);
+        const GridGraph &updated = current->graph;
+        TEST_CHECK(updated.size() == graph.size() && updated.arcCount() == graph.arcCount(),
+                   "updated graph of %u cells and %lu arcs after walk %d", updated.size(), updated.arcCount(), walk);
+        uint32_t shared = 0;
+        for (uint32_t index = 0; index < graph.size(); index++) {
+            TEST_CHECK(sameArcs(updated.arcsOf(index), graph.arcsOf(index)) &&
+                       sameArcs(updated.reverseArcsOf(index), graph.reverseArcsOf(index)),
+                       "arcs of cell %u of the updated graph differ after walk %d", index, walk);
+            TEST_CHECK(updated.point(index).x == graph.point(index).x && updated.point(index).y == graph.point(index).y,
+                       "point of cell %u of the updated graph differs after walk %d", index, walk);
+            if (index < previous->graph.size() && updated.arcsOf(index).data() == previous->graph.arcsOf(index).data()) {
+                shared++;
+            }
+        }
+        // One walk touches a few blocks of a city, the others are shared with the previous snapshot
+        TEST_CHECK(shared > 0, "updated graph shares no arcs with the previous one after walk %d", walk);
+        previous = current;
+        TEST_CHECK(updated.heuristicScale <= graph.heuristicScale && updated.minWeight <= graph.minWeight,
+                   "bounds of the updated graph rose above the built ones after walk %d", walk);
+        TEST_CHECK(current->cellIndex.size() == gridData.cellIds.size(), "cell index of %lu cells instead of %lu",
+                   current->cellIndex.size(), gridData.cellIds.size());
+        for (uint32_t index = 0; index < gridData.cellIds.size(); index++) {
+            TEST_CHECK(current->getCellIndex(gridData.cellIds[index]) == index, "cell %u is indexed as %u", index,
+                       current->getCellIndex(gridData.cellIds[index]));
+        }
+    }
+    return true;
+}
+
+// One search per origin answers every destination like a OneToOne search of its own, duplicated targets included
+bool testDijkstraToMany() {
+    mt19937_64 random(8);
+    CityQueries queries = cityQueries(random);
+    const GridGraph &graph = queries.snapshot->graph;
+
+    vector<uint32_t> destinations;
+    for (int i = 0; i < TEST_MATRIX_SIDE; i++) destinations.push_back(random() % graph.size());
+    destinations.push_back(destinations[0]);
+    ankerl::unordered_dense::map<uint32_t, uint32_t> targets;
+    for (uint32_t destinationIndex: destinations) targets.try_emplace(destinationIndex, targets.size());
+
+    vector<uint64_t> targetDistances;
+    for (uint32_t originIndex: queries.origins) {
+        for (bool exhaustive: {false, true}) {
+            uint64_t sum = dijkstraToMany(graph, originIndex, targets, exhaustive, targetDistances);
+            for (uint32_t destinationIndex: destinations) {
+                uint64_t distance = targetDistances[targets[destinationIndex]];
+                if (distance == UNREACHED) distance = sum;
+                uint64_t expected = dijkstra(graph, originIndex, destinationIndex, ONE_TO_ONE);
+                TEST_CHECK(distance == expected, "search to many from %u answers %lu for %u instead of %lu",
+                           originIndex, distance, destinationIndex, expected);
+            }
+            if (exhaustive) {
+                uint64_t total = dijkstra(graph, originIndex, NO_CELL, ONE_TO_ALL);
+                TEST_CHECK(sum == total, "exhaustive search to many from %u sums %lu instead of %lu", originIndex,
+                           sum, total);
+            }
+        }
+    }
+    return true;
+}
+
+// Every cell of a ManyToMany answer equals the OneToOne search of its pair, unknown locations included
+bool testManyToMany() {
+    mt19937_64 random(9);
+    CityQueries queries = cityQueries(random);
+    const GridGraph &graph = queries.snapshot->graph;
+
+    esw::ManyToMany manyToMany;
+    auto addLocation = [&](esw::Location *location, bool known) {
+        const GraphPoint &point = graph.point(random() % graph.size());
+        location->set_x(known ? static_cast<int32_t>(point.x) : TEST_NOWHERE);
+        location->set_y(known ? static_cast<int32_t>(point.y) : TEST_NOWHERE);
+    };
+    for (int i = 0; i < TEST_MATRIX_SIDE; i++) addLocation(manyToMany.add_origins(), i != 1);
+    for (int i = 0; i < TEST_MATRIX_SIDE; i++) addLocation(manyToMany.add_destinations(), i != 2);
+
+    vector<uint64_t> distances = processManyToMany(gridData, gridStats, manyToMany);
+    TEST_CHECK(distances.size() == TEST_MATRIX_SIDE * TEST_MATRIX_SIDE, "ManyToMany answered %lu distances",
+               distances.size());
+    auto cellOf = [&](const esw::Location &location) {
+        Point point = {static_cast<uint64_t>(location.x()), static_cast<uint64_t>(location.y())};
+        return queries.snapshot->getCellIndex(queries.snapshot->getPointCellId(point));
+    };
+    TEST_CHECK(cellOf(manyToMany.origins(1)) == NO_CELL, "location outside the city has a cell");
+    for (int row = 0; row < TEST_MATRIX_SIDE; row++) {
+        for (int column = 0; column < TEST_MATRIX_SIDE; column++) {
+            uint32_t originIndex = cellOf(manyToMany.origins(row));
+            uint32_t destinationIndex = cellOf(manyToMany.destinations(column));
+            uint64_t expected = dijkstra(graph, originIndex, destinationIndex, ONE_TO_ONE);
+            uint64_t distance = distances[row * TEST_MATRIX_SIDE + column];
+            TEST_CHECK(distance == expected, "ManyToMany answers %lu from %u to %u instead of %lu", distance,
+                       originIndex, destinationIndex, expected);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,184 @@
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "GridTests.hh"
+#include "GridStore.hh"
+
+// Global variables -------------------------------------------------------------------------------
+// Log generation the test snapshots record
+#define TEST_LOG_GENERATION 7
+// Walks logged before and after the reset in the middle of the test log
+#define TEST_LOG_WALKS      200
+
+// Class definition -------------------------------------------------------------------------------
+// Path of a file of this test process, so tests running side by side do not share it
+static string testPath(const char *name) {
+    return "/tmp/grid_tests." + to_string(getpid()) + "." + name;
+}
+
+// Images of the same grid agree in everything but the version, which a load only moves forward
+static bool sameGrid(const vector<char> &expected, const vector<char> &actual) {
+    TEST_CHECK(expected.size() == actual.size(), "image of %lu bytes instead of %lu", actual.size(),
+               expected.size());
+    const auto *expectedHeader = reinterpret_cast<const SnapshotHeader *>(expected.data());
+    const auto *actualHeader = reinterpret_cast<const SnapshotHeader *>(actual.data());
+    TEST_CHECK(actualHeader->cellCount == expectedHeader->cellCount &&
+               actualHeader->edgeCount == expectedHeader->edgeCount,
+               "%lu cells and %lu edges instead of %lu and %lu", actualHeader->cellCount, actualHeader->edgeCount,
+               expectedHeader->cellCount, expectedHeader->edgeCount);
+    TEST_CHECK(memcmp(expected.data() + sizeof(SnapshotHeader), actual.data() + sizeof(SnapshotHeader),
+                      expected.size() - sizeof(SnapshotHeader)) == 0, "cells or edges differ");
+    return true;
+}
+
+// A loaded snapshot restores the cells, edges and versions it was taken of, and the searches on it
+bool testSnapshotRoundTrip() {
+    mt19937_64 random(19);
+    generateCityWalks(gridData, gridStats, random, TEST_CITY_WALKS);
+    auto before = gridData.publishSnapshot();
+    vector<char> image = captureSnapshot(gridData, TEST_LOG_GENERATION);
+    uint64_t edges = gridStats.edges_count;
+
+    string path = testPath("snapshot");
+    TEST_CHECK(writeSnapshot(image, path), "cannot write the snapshot to %s", path.c_str());
+    gridData.resetGrid(gridStats);
+    uint64_t logGeneration = 0;
+    bool loaded = loadSnapshot(gridData, gridStats, path, logGeneration);
+    unlink(path.c_str());
+    TEST_CHECK(loaded, "cannot load the snapshot from %s", path.c_str());
+
+    TEST_CHECK(logGeneration == TEST_LOG_GENERATION, "log generation %lu instead of %d", logGeneration,
+               TEST_LOG_GENERATION);
+    uint64_t version = gridData.version;
+    TEST_CHECK(version > before->version, "version %lu not past %lu", version, before->version);
+    uint64_t edgesCounted = gridStats.edges_count;
+    TEST_CHECK(edgesCounted == edges, "%lu edges counted instead of %lu", edgesCounted, edges);
+    if (!sameGrid(image, captureSnapshot(gridData, TEST_LOG_GENERATION))) return false;
+
+    auto after = gridData.publishSnapshot();
+    TEST_CHECK(after->version > before->version, "snapshot version %lu not past %lu", after->version,
+               before->version);
+    uint32_t size = before->graph.size();
+    TEST_CHECK(after->graph.size() == size, "graph of %u cells instead of %u", after->graph.size(), size);
+    for (int i = 0; i < TEST_ONE_TO_ONE; i++) {
+        uint32_t originIndex = random() % size;
+        uint32_t destinationIndex = random() % size;
+        uint64_t distance = dijkstra(before->graph, originIndex, destinationIndex, ONE_TO_ONE);
+        TEST_CHECK(dijkstra(after->graph, originIndex, destinationIndex, ONE_TO_ONE) == distance,
+                   "OneToOne from %u to %u differs after the load", originIndex, destinationIndex);
+    }
+    return true;
+}
+
+// Writes the image and expects the load to reject it and leave the grid as it was
+static bool rejected(const char *name, const vector<char> &image, const vector<char> &grid) {
+    string path = testPath("snapshot");
+    TEST_CHECK(writeSnapshot(image, path), "cannot write the %s snapshot to %s", name, path.c_str());
+    uint64_t logGeneration = 0;
+    bool loaded = loadSnapshot(gridData, gridStats, path, logGeneration);
+    unlink(path.c_str());
+    TEST_CHECK(!loaded, "%s snapshot was loaded", name);
+    return sameGrid(grid, captureSnapshot(gridData, TEST_LOG_GENERATION));
+}
+
+// Missing, truncated and corrupted snapshots are rejected before they replace the grid
+bool testSnapshotValidation() {
+    mt19937_64 random(20);
+    generateCityWalks(gridData, gridStats, random, TEST_CITY_WALKS);
+    vector<char> grid = captureSnapshot(gridData, TEST_LOG_GENERATION);
+    const auto *header = reinterpret_cast<const SnapshotHeader *>(grid.data());
+    SnapshotLayout layout(header->cellCount, header->edgeCount);
+    TEST_CHECK(header->edgeCount > 0, "test grid has no edges");
+
+    uint64_t logGeneration = 0;
+    TEST_CHECK(!loadSnapshot(gridData, gridStats, testPath("missing"), logGeneration), "missing snapshot was loaded");
+    if (!rejected("empty", {}, grid)) return false;
+
+    vector<char> image(grid.begin(), grid.begin() + sizeof(SnapshotHeader) / 2);
+    if (!rejected("header-truncated", image, grid)) return false;
+    image.assign(grid.begin(), grid.end() - 1);
+    if (!rejected("truncated", image, grid)) return false;
+
+    image = grid;
+    reinterpret_cast<SnapshotHeader *>(image.data())->magic ^= 1;
+    if (!rejected("foreign", image, grid)) return false;
+    image = grid;
+    reinterpret_cast<SnapshotHeader *>(image.data())->format = SNAPSHOT_FORMAT + 1;
+    if (!rejected("newer format", image, grid)) return false;
+    image = grid;
+    reinterpret_cast<SnapshotHeader *>(image.data())->cellCount = NO_CELL;
+    if (!rejected("oversized", image, grid)) return false;
+
+    image = grid;
+    reinterpret_cast<uint64_t *>(image.data() + layout.edgeOffsets)[1] = header->edgeCount + 1;
+    if (!rejected("unordered offsets", image, grid)) return false;
+    image = grid;
+    reinterpret_cast<Edge *>(image.data() + layout.inEdges)[header->edgeCount - 1].index = header->cellCount;
+    if (!rejected("dangling edge", image, grid)) return false;
+    image = grid;
+    reinterpret_cast<Edge *>(image.data() + layout.edges)[0].samples = 0;
+    if (!rejected("unsampled edge", image, grid)) return false;
+    return true;
+}
+
+// Walks of a few random locations, with a reset between the first and the second half
+static vector<esw::Request> loggedRequests(mt19937_64 &random) {
+    uniform_int_distribution<int32_t> coordinate(0, 2000000);
+    vector<esw::Request> requests(2 * TEST_LOG_WALKS + 1);
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (i == TEST_LOG_WALKS) {
+            requests[i].mutable_reset();
+            continue;
+        }
+        esw::Walk *walk = requests[i].mutable_walk();
+        for (int location = 0; location < 4; location++) {
+            walk->add_locations()->set_x(coordinate(random));
+            walk->mutable_locations(location)->set_y(coordinate(random));
+            if (location > 0) walk->add_lengths(1000 + random() % 100000);
+        }
+    }
+    return requests;
+}
+
+// A log cut within its last record replays the complete records as if they were applied directly
+bool testLogReplay() {
+    mt19937_64 random(21);
+    vector<esw::Request> requests = loggedRequests(random);
+    string log;
+    for (const esw::Request &request: requests) {
+        uint32_t networkSize = htonl(request.ByteSizeLong());
+        log.append(reinterpret_cast<const char *>(&networkSize), sizeof(networkSize));
+        log.append(request.SerializeAsString());
+    }
+
+    for (const esw::Request &request: requests) {
+        if (request.has_walk()) processWalk(gridData, gridStats, request.walk());
+        if (request.has_reset()) processReset(gridData, gridStats);
+    }
+    vector<char> grid = captureSnapshot(gridData, TEST_LOG_GENERATION);
+    TEST_CHECK(reinterpret_cast<const SnapshotHeader *>(grid.data())->edgeCount > 0, "logged walks add no edges");
+
+    string path = testPath("wal");
+    uint64_t records = 0;
+    TEST_CHECK(!replayLog(gridData, gridStats, path, records) && records == 0, "missing log was replayed");
+
+    // One more walk cut in its length, then in its body
+    esw::Request last = loggedRequests(random).front();
+    uint32_t networkSize = htonl(last.ByteSizeLong());
+    string record = string(reinterpret_cast<const char *>(&networkSize), sizeof(networkSize)) +
+                    last.SerializeAsString();
+    for (size_t cut: {sizeof(networkSize) / 2, sizeof(networkSize) + record.size() / 2}) {
+        ofstream(path, ios::binary | ios::trunc) << log << record.substr(0, cut);
+        gridData.resetGrid(gridStats);
+        records = 0;
+        bool replayed = replayLog(gridData, gridStats, path, records);
+        unlink(path.c_str());
+        TEST_CHECK(replayed, "cannot replay the log from %s", path.c_str());
+        TEST_CHECK(records == requests.size(), "%lu records replayed instead of %lu from a log cut after %lu "
+                                               "bytes of the last one", records, requests.size(), cut);
+        if (!sameGrid(grid, captureSnapshot(gridData, TEST_LOG_GENERATION))) return false;
+    }
+    return true;
+}
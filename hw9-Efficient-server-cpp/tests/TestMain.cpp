@@ -0,0 +1,63 @@
+#include <cstring>
+
+#include "GridTests.hh"
+
+// Global variables -------------------------------------------------------------------------------
+PrefixedLogger testLogger = PrefixedLogger("[TEST      ]", true);
+
+GridData gridData = GridData();
+GridStats gridStats = GridStats();
+
+// Helpers are forced even on few cores so that the parallel search is always checked
+ThreadPool resourcePool1(max<uint32_t>(3, thread::hardware_concurrency() - 1));
+
+// Class definition -------------------------------------------------------------------------------
+struct TestCase {
+    const char *name;
+    bool (*run)();
+};
+
+// Names of the tests as ctest runs them, every one in a process and on a grid of its own
+static const TestCase testCases[] = {
+        {"search_queues",           testSearchQueues},
+        {"delta_stepping",          testDeltaStepping},
+        {"incremental_one_to_all",  testIncrementalOneToAll},
+        {"snapshot_update",         testSnapshotUpdate},
+        {"dijkstra_to_many",        testDijkstraToMany},
+        {"many_to_many",            testManyToMany},
+        {"batch_resolution",        testBatchResolution},
+        {"query_cache_versions",    testQueryCacheVersions},
+        {"query_cache_coalescing",  testQueryCacheCoalescing},
+        {"query_cache_eviction",    testQueryCacheEviction},
+        {"ingest_queue_order",      testIngestQueueOrder},
+        {"ingest_queue_wait",       testIngestQueueWait},
+        {"snapshot_round_trip",     testSnapshotRoundTrip},
+        {"snapshot_validation",     testSnapshotValidation},
+        {"log_replay",              testLogReplay},
+};
+
+// Main function -----------------------------------------------------------------------------------
+// Runs the named tests, all of them without a name, and fails when any of them does
+int main(int argc, char *argv[]) {
+    uint32_t failures = 0;
+    int ran = 0;
+    for (const TestCase &testCase: testCases) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; i++) selected |= strcmp(argv[i], testCase.name) == 0;
+        if (!selected) continue;
+
+        ran++;
+        bool passed = testCase.run();
+        if (passed) {
+            testLogger.info("%s passed", testCase.name);
+        } else {
+            testLogger.error("%s failed", testCase.name);
+            failures++;
+        }
+    }
+    if (argc > 1 && ran != argc - 1) {
+        testLogger.error("%d of the %d tests named are unknown", argc - 1 - ran, argc - 1);
+        failures++;
+    }
+    return failures > 0 ? 1 : 0;
+}